@@ -0,0 +1,75 @@
+// Builds the paths and compile command of 1000 targets per build phase, once on the heap and once in an arena
+// that is reset after every phase, the arena makes no malloc calls once its blocks are warm
+#define CBUILDER_STATS
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+size_t buildPhase(CBuild_Arena *arena, int phase)
+{
+    size_t checksum = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "module_%03d/unit_%04d", phase % 100, i);
+
+        CBuild_String srcPath = CBuild_String_initArena(arena, "./src/");
+        CBuild_String_concatCStrArena(arena, &srcPath, name);
+        CBuild_String_concatCStrArena(arena, &srcPath, ".cpp");
+
+        CBuild_String outPath = CBuild_String_initArena(arena, "./build/");
+        CBuild_String_concatCStrArena(arena, &outPath, name);
+        CBuild_String_concatCStrArena(arena, &outPath, ".o");
+
+        CBuild_String command = CBuild_String_initArena(arena, "g++ -O2 -Wall -Iinclude -c ");
+        CBuild_String_concatArena(arena, &command, &srcPath);
+        CBuild_String_concatCStrArena(arena, &command, " -o ");
+        CBuild_String_concatArena(arena, &command, &outPath);
+        CBuild_String_concatCStrArena(arena, &command, " -MMD -MF ");
+        CBuild_String_concatArena(arena, &command, &outPath);
+        CBuild_String_concatCStrArena(arena, &command, ".d");
+
+        checksum += command.len;
+
+        CBuild_String_deinit(&srcPath); // no-ops for arena strings
+        CBuild_String_deinit(&outPath);
+        CBuild_String_deinit(&command);
+    }
+
+    if (arena)
+    {
+        CBuild_Arena_reset(arena);
+    }
+    return checksum;
+}
+
+void run(CBuild_Arena *arena, const char *label)
+{
+    CBuild_allocStats = (CBuild_AllocStats){0, 0, 0, 0};
+    size_t checksum = 0;
+
+    double start = CBuild_nowNs() / 1e6;
+    for (int phase = 0; phase < 100; phase++)
+    {
+        checksum += buildPhase(arena, phase);
+    }
+    double ms = CBuild_nowNs() / 1e6 - start;
+
+    printf("%s: 100 phases x 1000 targets, %.3f ms, %.1f ns per target\n", label, ms, ms * 1e6 / 100000);
+    printf("    mallocs %ld, reallocs %ld, frees %ld (checksum %zu)\n", CBuild_allocStats.mallocs,
+           CBuild_allocStats.reallocs, CBuild_allocStats.frees, checksum);
+}
+
+int main()
+{
+    run(NULL, "heap ");
+
+    CBuild_Arena arena;
+    CBuild_Arena_init(&arena, 0);
+    run(&arena, "arena");
+    printf("    arena allocations %ld, blocks %ld\n", arena.allocs, arena.blockMallocs);
+    CBuild_Arena_deinit(&arena);
+
+    CBuild_String_releasePool();
+    return 0;
+}
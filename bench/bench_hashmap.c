@@ -0,0 +1,124 @@
+// Inserts and looks up 1M keys in CBuild_HashMap, integer keys (for example content hashes) and path keys
+// (const char * with the string hash), lookups are split into hits and misses
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+#define KEYS (1 << 20)
+
+uint64_t mix(uint64_t x) // spreads the sequential ids into random looking keys
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return x;
+}
+
+void report(const char *label, double ms)
+{
+    printf("    %-16s %8.3f ms, %6.1f ns per op\n", label, ms, ms * 1e6 / KEYS);
+}
+
+int main()
+{
+    printf("integer keys, %d keys:\n", KEYS);
+    {
+        CBuild_HashMap map;
+        CBuild_HashMap_init(&map, sizeof(uint64_t), sizeof(uint32_t), NULL, NULL);
+
+        double start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            uint64_t key = mix(i);
+            CBuild_HashMap_put(&map, &key, &i);
+        }
+        report("insert", CBuild_nowNs() / 1e6 - start);
+
+        CBuild_HashMap sized; // the same inserts without any rehash on the way
+        CBuild_HashMap_init(&sized, sizeof(uint64_t), sizeof(uint32_t), NULL, NULL);
+        CBuild_HashMap_reserve(&sized, KEYS);
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            uint64_t key = mix(i);
+            CBuild_HashMap_put(&sized, &key, &i);
+        }
+        report("insert reserved", CBuild_nowNs() / 1e6 - start);
+        CBuild_HashMap_deinit(&sized);
+
+        uint64_t sum = 0;
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            uint64_t key = mix(i);
+            sum += *(uint32_t *)CBuild_HashMap_get(&map, &key);
+        }
+        report("lookup hit", CBuild_nowNs() / 1e6 - start);
+
+        int misses = 0;
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = KEYS; i < 2 * KEYS; i++)
+        {
+            uint64_t key = mix(i);
+            misses += CBuild_HashMap_get(&map, &key) == NULL;
+        }
+        report("lookup miss", CBuild_nowNs() / 1e6 - start);
+
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            uint64_t key = mix(i);
+            CBuild_HashMap_remove(&map, &key);
+        }
+        report("remove", CBuild_nowNs() / 1e6 - start);
+
+        printf("    (sum %llu, misses %d, left %u)\n", (unsigned long long)sum, misses, map.count);
+        CBuild_HashMap_deinit(&map);
+    }
+
+    printf("path keys, %d keys:\n", KEYS);
+    {
+        CBuild_Arena arena;
+        CBuild_Arena_init(&arena, 0);
+        const char **paths = (const char **)malloc(2 * KEYS * sizeof(const char *));
+        for (int i = 0; i < 2 * KEYS; i++)
+        {
+            char path[96];
+            int len = snprintf(path, sizeof(path), "/usr/include/c++/12/module_%04d/header_%07d.h", i % 1000, i);
+            paths[i] = CBuild_Arena_strdup(&arena, path, len);
+        }
+
+        CBuild_HashMap map;
+        CBuild_HashMap_init(&map, sizeof(const char *), sizeof(uint32_t), CBuild_HashMap_hashCStr, CBuild_HashMap_equalsCStr);
+
+        double start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            CBuild_HashMap_put(&map, &paths[i], &i);
+        }
+        report("insert", CBuild_nowNs() / 1e6 - start);
+
+        uint64_t sum = 0;
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = 0; i < KEYS; i++)
+        {
+            sum += *(uint32_t *)CBuild_HashMap_get(&map, &paths[i]);
+        }
+        report("lookup hit", CBuild_nowNs() / 1e6 - start);
+
+        int misses = 0;
+        start = CBuild_nowNs() / 1e6;
+        for (uint32_t i = KEYS; i < 2 * KEYS; i++)
+        {
+            misses += CBuild_HashMap_get(&map, &paths[i]) == NULL;
+        }
+        report("lookup miss", CBuild_nowNs() / 1e6 - start);
+
+        printf("    (sum %llu, misses %d)\n", (unsigned long long)sum, misses);
+        CBuild_HashMap_deinit(&map);
+        free(paths);
+        CBuild_Arena_deinit(&arena);
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Compares the latency of starting a trivial process through system() (CBuild_system)
+// against the shell free posix_spawn path (CBuild_spawn)
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+#define RUNS 500
+
+int main()
+{
+    double start = CBuild_nowNs() / 1e6;
+    for (int i = 0; i < RUNS; i++)
+    {
+        CBuild_system("true", "", "system() failed\n");
+    }
+    double systemMs = CBuild_nowNs() / 1e6 - start;
+
+    char *argv[] = {"true", NULL};
+    start = CBuild_nowNs() / 1e6;
+    for (int i = 0; i < RUNS; i++)
+    {
+        CBuild_spawn(argv, "", "spawn failed\n");
+    }
+    double spawnMs = CBuild_nowNs() / 1e6 - start;
+
+    printf("system():    %8.3f ms per process\n", systemMs / RUNS);
+    printf("posix_spawn: %8.3f ms per process\n", spawnMs / RUNS);
+    printf("speedup:     %8.2fx\n", systemMs / spawnMs);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Builds the source, object and depfile paths of 100k translation units the way main.c does, short strings
+// reuse cached buffers so the steady state does no heap calls, build with -DCBUILDER_SMALL_POOL_MAX=0 to compare
+#define CBUILDER_STATS
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+int main()
+{
+    const int units = 100000;
+    CBuild_String buildDir = CBuild_String_init("./build/");
+    size_t checksum = 0;
+
+    CBuild_allocStats = (CBuild_AllocStats){0, 0, 0, 0};
+    double start = CBuild_nowNs() / 1e6;
+    for (int i = 0; i < units; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "unit_%06d", i);
+
+        CBuild_String srcPath = CBuild_String_init("./src/");
+        CBuild_String_concatCStr(&srcPath, name);
+        CBuild_String_concatCStr(&srcPath, ".cpp");
+
+        CBuild_String outPath = CBuild_String_copy(&buildDir);
+        CBuild_String_concatCStr(&outPath, name);
+        CBuild_String_concatCStr(&outPath, ".o");
+
+        CBuild_String depPath = CBuild_String_copy(&buildDir);
+        CBuild_String_concatCStr(&depPath, name);
+        CBuild_String_concatCStr(&depPath, ".d");
+
+        checksum += srcPath.len + outPath.len + depPath.len;
+
+        CBuild_String_deinit(&srcPath);
+        CBuild_String_deinit(&outPath);
+        CBuild_String_deinit(&depPath);
+    }
+    double ms = CBuild_nowNs() / 1e6 - start;
+
+    printf("short string cache %s: %d units, %.3f ms, %.1f ns per path\n",
+           CBUILDER_SMALL_POOL_MAX ? "on " : "off", units, ms, ms * 1e6 / (units * 3.0));
+    printf("    mallocs %ld, reallocs %ld, frees %ld, cache hits %ld (checksum %zu)\n",
+           CBuild_allocStats.mallocs, CBuild_allocStats.reallocs, CBuild_allocStats.frees,
+           CBuild_allocStats.poolHits, checksum);
+
+    CBuild_String_deinit(&buildDir);
+    CBuild_String_releasePool();
+    return 0;
+}
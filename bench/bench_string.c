@@ -0,0 +1,30 @@
+// Builds link command lines of growing size from short object paths, with geometric growth the time per
+// byte stays flat as the command grows (linear total time)
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+int main()
+{
+    int sizes[] = {64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20};
+    for (int i = 0; i < 5; i++)
+    {
+        double start = CBuild_nowNs() / 1e6;
+        int pieces = 0;
+
+        CBuild_String command = CBuild_String_init("g++ ./sample/main.cpp ");
+        while (command.len < sizes[i])
+        {
+            char object[32];
+            snprintf(object, sizeof(object), "./build/obj_%06d.o ", pieces++);
+            CBuild_String_concatCStr(&command, object);
+        }
+        CBuild_String_concatCStr(&command, "-o ./build/main.exe");
+
+        double ms = CBuild_nowNs() / 1e6 - start;
+        printf("%6d KB command, %7d objects: %8.3f ms, %6.2f ns per byte\n", command.len >> 10, pieces, ms, ms * 1e6 / command.len);
+        CBuild_String_deinit(&command);
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Splits multi megabyte directory listings and depfiles with the strchr per byte tokenizer the library used
+// before and with the lookup table / SIMD tokenizer, build with -mavx2 to compare the AVX2 path to SSE2
+#include <stdio.h>
+
+#include "../cbuilder/cbuilder.h"
+
+// the previous implementation of CBuild_String_tokenizer
+void strchrTokenizer(CBuild_String *original, CBuild_String *prevToken, const char *delim)
+{
+    if (prevToken->str == NULL)
+    {
+        prevToken->str = original->str;
+        prevToken->len = 0;
+        prevToken->buf_len = 0;
+    }
+    else
+    {
+        prevToken->str += prevToken->len + 1;
+    }
+
+    char *ptr = prevToken->str;
+    while (strchr(delim, *ptr) != NULL && *ptr != '\0')
+    {
+        ptr++;
+    }
+
+    prevToken->str = ptr;
+    int len = 0;
+    while (strchr(delim, *ptr) == NULL && ptr - original->str < original->len)
+    {
+        len++;
+        ptr++;
+    }
+
+    prevToken->len = len;
+}
+
+void run(const char *label, CBuild_String *input, const char *delim)
+{
+    double best[2] = {1e30, 1e30};
+    size_t sums[2] = {0, 0};
+    int counts[2] = {0, 0};
+
+    CBuild_DelimSet set;
+    CBuild_DelimSet_init(&set, delim);
+
+    for (int rep = 0; rep < 5; rep++)
+    {
+        for (int impl = 0; impl < 2; impl++)
+        {
+            CBuild_String token = {NULL, 0, 0};
+            size_t sum = 0;
+            int count = 0;
+
+            double start = CBuild_nowNs() / 1e6;
+            while (1)
+            {
+                if (impl == 0)
+                {
+                    strchrTokenizer(input, &token, delim);
+                }
+                else
+                {
+                    CBuild_String_tokenizerSet(input, &token, &set);
+                }
+
+                if (token.str[0] == '\0')
+                {
+                    break;
+                }
+                sum += token.len + (token.str - input->str);
+                count++;
+            }
+            double ms = CBuild_nowNs() / 1e6 - start;
+
+            best[impl] = ms < best[impl] ? ms : best[impl];
+            sums[impl] = sum;
+            counts[impl] = count;
+        }
+    }
+
+    double mb = input->len / (1024.0 * 1024.0);
+    printf("%s: %.1f MB, %d tokens%s\n", label, mb, counts[1], sums[0] == sums[1] && counts[0] == counts[1] ? "" : " MISMATCH");
+    printf("    strchr   %8.3f ms, %7.1f MB/s\n", best[0], mb * 1e3 / best[0]);
+    printf("    delimset %8.3f ms, %7.1f MB/s, %.1fx\n", best[1], mb * 1e3 / best[1], best[0] / best[1]);
+}
+
+int main()
+{
+#ifdef __AVX2__
+    printf("vector path: AVX2\n");
+#elif defined(__SSE2__)
+    printf("vector path: SSE2\n");
+#else
+    printf("vector path: none\n");
+#endif
+
+    // a delimited listing as written by CBuild_Fs_dir
+    CBuild_String listing = CBuild_String_init("");
+    for (int i = 0; listing.len < (8 << 20); i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "module_%04d/source_file_%06d.cpp:", i % 1000, i);
+        CBuild_String_concatCStr(&listing, name);
+    }
+    run("listing (\":\")", &listing, ":");
+
+    // a depfile with continuations, split on whitespace and the escape character
+    CBuild_String depfile = CBuild_String_init("build/main.o: src/main.cpp \\\n");
+    for (int i = 0; depfile.len < (8 << 20); i++)
+    {
+        char line[96];
+        snprintf(line, sizeof(line), " /usr/include/c++/12/bits/header_number_%06d.h \\\n", i);
+        CBuild_String_concatCStr(&depfile, line);
+    }
+    run("depfile (\" \\t\\r\\n\\\\\")", &depfile, " \t\r\n\\");
+
+    CBuild_String_deinit(&listing);
+    CBuild_String_deinit(&depfile);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Compares the serial CBuild_Fs_walk against CBuild_Fs_walkParallel on a synthetic tree of about 200k files,
+// the tree is created under /tmp on the first run, pass another root as the first argument to use a real tree
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../cbuilder/cbuilder.h"
+
+#define TOP_FOLDERS 100
+#define SUB_FOLDERS 20
+#define FILES_PER_FOLDER 100
+
+void createTree(const char *root)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%d/%d", root, TOP_FOLDERS - 1, SUB_FOLDERS - 1);
+    if (!access(path, F_OK))
+    {
+        return; // created by an earlier run
+    }
+
+    printf("Creating %d files under %s...\n", TOP_FOLDERS * SUB_FOLDERS * FILES_PER_FOLDER, root);
+    for (int i = 0; i < TOP_FOLDERS; i++)
+    {
+        for (int j = 0; j < SUB_FOLDERS; j++)
+        {
+            snprintf(path, sizeof(path), "%s/%d/%d", root, i, j);
+            CBuild_Fs_mkdir(path);
+            for (int k = 0; k < FILES_PER_FOLDER; k++)
+            {
+                snprintf(path, sizeof(path), "%s/%d/%d/file%d.cpp", root, i, j, k);
+                close(open(path, O_CREAT | O_WRONLY, 0644));
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *root = argc > 1 ? argv[1] : "/tmp/cbuilder_bench_tree";
+    if (argc <= 1)
+    {
+        createTree(root);
+    }
+
+    CBuild_FsList list;
+    CBuild_FsList_init(&list);
+    double start = CBuild_nowNs() / 1e6;
+    CBuild_Fs_walk(root, CBUILD_FS_DIRMODE_FILES, CBUILD_FS_WALK_RECURSIVE, &list);
+    CBuild_FsList_sort(&list);
+    printf("serial:      %8.2f ms, %d files\n", CBuild_nowNs() / 1e6 - start, list.count);
+    CBuild_FsList_deinit(&list);
+
+    int threadCounts[] = {2, 4, 8, 16};
+    for (int i = 0; i < 4; i++)
+    {
+        CBuild_FsList_init(&list);
+        start = CBuild_nowNs() / 1e6;
+        CBuild_Fs_walkParallel(root, CBUILD_FS_DIRMODE_FILES, CBUILD_FS_WALK_RECURSIVE, threadCounts[i], &list);
+        printf("%2d threads: %8.2f ms, %d files\n", threadCounts[i], CBuild_nowNs() / 1e6 - start, list.count);
+        CBuild_FsList_deinit(&list);
+    }
+
+    return 0;
+}
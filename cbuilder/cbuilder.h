@@ -2,7 +2,18 @@
 #define INCLUDED_CBUILDER
 
 #include "cbuilder_string.h"
+#include "cbuilder_arena.h"
+#include "cbuilder_intern.h"
+#include "cbuilder_list.h"
+#include "cbuilder_trace.h"
+#include "cbuilder_jobserver.h"
 #include "cbuilder_exec.h"
+#include "cbuilder_glob.h"
 #include "cbuilder_fs.h"
+#include "cbuilder_deps.h"
+#include "cbuilder_db.h"
+#include "cbuilder_cache.h"
+#include "cbuilder_graph.h"
+#include "cbuilder_toolchain.h"
 
 #endif // INCLUDED_CBUILDER
\ No newline at end of file
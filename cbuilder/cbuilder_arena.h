@@ -0,0 +1,301 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_ARENA
+#define INCLUDED_CBUILDER_ARENA
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cbuilder_string.h"
+
+#define CBUILDER_ARENA_BLOCK (64 * 1024) // default usable bytes of an arena block
+
+typedef struct CBuild_ArenaBlock
+{
+    struct CBuild_ArenaBlock *next;
+    size_t size; // usable bytes, the data follows this header
+    size_t used; // bytes handed out from this block
+} CBuild_ArenaBlock;
+
+typedef struct
+{
+    CBuild_ArenaBlock *head;    // first block, the blocks are kept across resets
+    CBuild_ArenaBlock *current; // block allocations are served from
+    size_t blockSize;           // usable bytes of a new block, larger requests get a block of their own size
+    long allocs;                // allocations served since init
+    long blockMallocs;          // blocks requested from malloc since init, stays flat in steady state
+} CBuild_Arena;
+
+/**
+ * @brief Initialises a bump allocator for memory that lives until the end of a build phase, nothing is
+ *        allocated until the first CBuild_Arena_alloc
+ *
+ * @param arena The CBuild_Arena * to initialise, must be freed with CBuild_Arena_deinit
+ * @param blockSize The usable bytes of each block, 0 for CBUILDER_ARENA_BLOCK
+ */
+void CBuild_Arena_init(CBuild_Arena *arena, size_t blockSize)
+{
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->blockSize = blockSize ? blockSize : CBUILDER_ARENA_BLOCK;
+    arena->allocs = 0;
+    arena->blockMallocs = 0;
+}
+
+/**
+ * @brief Frees every block of the arena, all memory allocated from it becomes invalid
+ *
+ * @param arena The CBuild_Arena * to free
+ */
+void CBuild_Arena_deinit(CBuild_Arena *arena)
+{
+    CBuild_ArenaBlock *block = arena->head;
+    while (block)
+    {
+        CBuild_ArenaBlock *next = block->next;
+        CBUILD_STAT(frees);
+        free(block);
+        block = next;
+    }
+
+    arena->head = NULL;
+    arena->current = NULL;
+}
+
+/**
+ * @brief Releases all allocations of the arena at once, the blocks are kept so the next phase allocates
+ *        from them again without calling malloc @n
+ *        Note: all memory allocated from the arena becomes invalid
+ *
+ * @param arena The CBuild_Arena * to reset
+ */
+void CBuild_Arena_reset(CBuild_Arena *arena)
+{
+    if (arena->head)
+    {
+        arena->head->used = 0;
+    }
+    arena->current = arena->head;
+}
+
+// moves to the next kept block if it can hold size bytes, else links a new block after the current one
+CBuild_ArenaBlock *CBuild_Arena_nextBlock(CBuild_Arena *arena, size_t size)
+{
+    CBuild_ArenaBlock *prev = arena->current;
+    CBuild_ArenaBlock *block = prev ? prev->next : arena->head;
+    if (block && block->size >= size)
+    {
+        block->used = 0;
+        arena->current = block;
+        return block;
+    }
+
+    size_t blockSize = size > arena->blockSize ? size : arena->blockSize;
+    CBuild_ArenaBlock *newBlock = (CBuild_ArenaBlock *)malloc(sizeof(CBuild_ArenaBlock) + blockSize);
+    if (!newBlock)
+    {
+        fprintf(stderr, "[CBuilder Arena Error] Failed to allocate a block of %zu bytes\n", blockSize);
+        return NULL;
+    }
+    CBUILD_STAT(mallocs);
+    arena->blockMallocs++;
+
+    newBlock->size = blockSize;
+    newBlock->used = 0;
+    newBlock->next = block; // a kept block that was too small is reused later
+    if (prev)
+    {
+        prev->next = newBlock;
+    }
+    else
+    {
+        arena->head = newBlock;
+    }
+
+    arena->current = newBlock;
+    return newBlock;
+}
+
+/**
+ * @brief Allocates size bytes from the arena, aligned for any pointer or integer type, the memory is
+ *        released by CBuild_Arena_reset or CBuild_Arena_deinit and must not be passed to free
+ *
+ * @param arena The CBuild_Arena * to allocate from
+ * @param size The number of bytes to allocate
+ * @return void* The allocated memory, NULL if a new block could not be allocated
+ */
+void *CBuild_Arena_alloc(CBuild_Arena *arena, size_t size)
+{
+    CBuild_ArenaBlock *block = arena->current;
+    size_t start = block ? (block->used + 7) & ~(size_t)7 : 0;
+    if (!block || start + size > block->size)
+    {
+        block = CBuild_Arena_nextBlock(arena, size);
+        if (!block)
+        {
+            return NULL;
+        }
+        start = 0;
+    }
+
+    block->used = start + size; // not rounded, so the last string can grow in place
+    arena->allocs++;
+    return (char *)(block + 1) + start;
+}
+
+/**
+ * @brief Copies len bytes of str into the arena and \0 terminates them
+ *
+ * @param arena The CBuild_Arena * to allocate from
+ * @param str The bytes to copy
+ * @param len The number of bytes to copy
+ * @return char* The \0 terminated copy, NULL if the arena is out of memory
+ */
+char *CBuild_Arena_strdup(CBuild_Arena *arena, const char *str, size_t len)
+{
+    char *mem = (char *)CBuild_Arena_alloc(arena, len + 1);
+    if (mem)
+    {
+        memcpy(mem, str, len);
+        mem[len] = '\0';
+    }
+
+    return mem;
+}
+
+/**
+ * @brief Initialises a CBuild_String in the arena, it is a container string (buf_len 0) so CBuild_String_deinit
+ *        leaves it alone and the arena frees it on reset @n
+ *        Note: the plain CBuild_String calls still work on it, they move it to the heap on the first growth
+ *
+ * @param arena The CBuild_Arena * to allocate from, NULL to allocate on the heap like CBuild_String_init
+ * @param src The \0 terminated string to copy
+ * @return CBuild_String The arena string, {NULL, 0, 0} if the arena is out of memory
+ */
+CBuild_String CBuild_String_initArena(CBuild_Arena *arena, const char *src)
+{
+    if (!arena)
+    {
+        return CBuild_String_init(src);
+    }
+
+    size_t len = strlen(src);
+    char *mem = CBuild_Arena_strdup(arena, src, len);
+    return mem ? (CBuild_String){mem, (int)len, 0} : (CBuild_String){NULL, 0, 0};
+}
+
+/**
+ * @brief Appends len bytes of src to an arena string, the string grows in place when it is the last allocation
+ *        of the arena (the usual case while building a path or command), else it is copied to the top
+ *
+ * @param arena The CBuild_Arena * str was allocated from, NULL for heap strings
+ * @param str The CBuild_String * to append to, heap strings (buf_len != 0) keep growing on the heap
+ * @param src The bytes to append, need not be \0 terminated
+ * @param len The number of bytes to append
+ * @return CBuild_String* The reference to str
+ */
+CBuild_String *CBuild_String_appendArena(CBuild_Arena *arena, CBuild_String *str, const char *src, int len)
+{
+    if (!arena || str->buf_len)
+    {
+        return CBuild_String_append(str, src, len);
+    }
+
+    CBuild_ArenaBlock *block = arena->current;
+    if (block && str->str && str->str + str->len + 1 == (char *)(block + 1) + block->used &&
+        block->used + len <= block->size)
+    {
+        memmove(str->str + str->len, src, len); // src may be a part of str itself
+        block->used += len;
+    }
+    else
+    {
+        char *mem = (char *)CBuild_Arena_alloc(arena, str->len + len + 1);
+        if (!mem)
+        {
+            return str;
+        }
+
+        if (str->len)
+        {
+            memcpy(mem, str->str, str->len);
+        }
+        memcpy(mem + str->len, src, len); // the old copy stays valid until the reset
+        str->str = mem;
+    }
+
+    str->len += len;
+    str->str[str->len] = '\0';
+    return str;
+}
+
+/**
+ * @brief Concatenates str2 to the arena string str1, see CBuild_String_appendArena
+ *
+ * @param arena The CBuild_Arena * str1 was allocated from, NULL for heap strings
+ * @param str1 The CBuild_String * to append to
+ * @param str2 The CBuild_String * to append
+ * @return CBuild_String* The reference to str1
+ */
+CBuild_String *CBuild_String_concatArena(CBuild_Arena *arena, CBuild_String *str1, CBuild_String *str2)
+{
+    return CBuild_String_appendArena(arena, str1, str2->str, str2->len);
+}
+
+/**
+ * @brief Concatenates the \0 terminated str2 to the arena string str1, see CBuild_String_appendArena
+ *
+ * @param arena The CBuild_Arena * str1 was allocated from, NULL for heap strings
+ * @param str1 The CBuild_String * to append to
+ * @param str2 The \0 terminated string to append
+ * @return CBuild_String* The reference to str1
+ */
+CBuild_String *CBuild_String_concatCStrArena(CBuild_Arena *arena, CBuild_String *str1, const char *str2)
+{
+    return CBuild_String_appendArena(arena, str1, str2, strlen(str2));
+}
+
+/**
+ * @brief Copies any CBuild_String into a new arena string
+ *
+ * @param arena The CBuild_Arena * to allocate from, NULL to copy to the heap like CBuild_String_copy
+ * @param str The CBuild_String * to copy
+ * @return CBuild_String The arena copy, {NULL, 0, 0} if the arena is out of memory
+ */
+CBuild_String CBuild_String_copyArena(CBuild_Arena *arena, CBuild_String *str)
+{
+    if (!arena)
+    {
+        return CBuild_String_copy(str);
+    }
+
+    char *mem = CBuild_Arena_strdup(arena, str->str, str->len);
+    return mem ? (CBuild_String){mem, str->len, 0} : (CBuild_String){NULL, 0, 0};
+}
+
+#endif // INCLUDED_CBUILDER_ARENA
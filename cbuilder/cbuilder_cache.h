@@ -0,0 +1,226 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_CACHE
+#define INCLUDED_CBUILDER_CACHE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_fs.h"
+
+#define CBUILD_CACHE_SEED_LO 0x5ca1ab1e0ddba11ull
+#define CBUILD_CACHE_SEED_HI 0xc0ffee15deadbeefull
+
+/*
+ * A local object cache in the spirit of ccache, every entry is keyed on a 128 bit hash of the command line and
+ * the contents the output depends on, so it stays valid across fresh checkouts where mtimes are meaningless
+ */
+typedef struct
+{
+    uint64_t lo;
+    uint64_t hi;
+} CBuild_CacheKey;
+
+typedef struct
+{
+    CBuild_String dir; // root directory of the cache
+    int hits;          // number of successful CBuild_Cache_fetch calls
+    int misses;        // number of failed CBuild_Cache_fetch calls
+    int stores;        // number of entries added by CBuild_Cache_store
+} CBuild_Cache;
+
+/**
+ * @brief Initialises the cache rooted at dir, creating the directory if needed
+ *
+ * @param cache The CBuild_Cache * to initialise, must be freed with CBuild_Cache_deinit
+ * @param dir The cache directory, for example ~/.cache/cbuilder
+ * @return int 0 on success, -1 if the directory could not be created
+ */
+int CBuild_Cache_init(CBuild_Cache *cache, const char *dir)
+{
+    cache->dir = CBuild_String_init(dir);
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->stores = 0;
+
+    return CBuild_Fs_mkdir(dir);
+}
+
+/**
+ * @brief Frees the memory held by the cache, the entries stay on disk
+ *
+ * @param cache The CBuild_Cache * to free
+ */
+void CBuild_Cache_deinit(CBuild_Cache *cache)
+{
+    CBuild_String_deinit(&cache->dir);
+}
+
+/**
+ * @brief Starts a key from the hash of the command line, see CBuild_Db_hashArgv
+ *
+ * @param commandHash The hash of the command line that builds the outputs
+ * @return CBuild_CacheKey The key to add the inputs to
+ */
+CBuild_CacheKey CBuild_Cache_keyInit(uint64_t commandHash)
+{
+    return (CBuild_CacheKey){
+        CBuild_hash(&commandHash, sizeof(commandHash), CBUILD_CACHE_SEED_LO),
+        CBuild_hash(&commandHash, sizeof(commandHash), CBUILD_CACHE_SEED_HI)};
+}
+
+/**
+ * @brief Adds the contents of a file to the key, a preprocessed source makes the key exact even when no
+ *        dependency information is available yet, for example on a fresh checkout
+ *
+ * @param key The CBuild_CacheKey * to update
+ * @param path The path of the file, for example the source, one of its headers or the preprocessed source
+ * @return int 0 on success, -1 if the file could not be read, the key must not be used then
+ */
+int CBuild_Cache_keyAddFile(CBuild_CacheKey *key, const char *path)
+{
+    CBuild_String data = CBuild_Fs_readFile(path);
+    if (data.str == NULL)
+    {
+        return -1;
+    }
+
+    key->lo = CBuild_hash(data.str, data.len, key->lo);
+    key->hi = CBuild_hash(data.str, data.len, key->hi);
+
+    CBuild_String_deinit(&data);
+    return 0;
+}
+
+// builds <dir>/<first 2 hex digits>/<rest>.<index> into path, the entry of output index of key
+void CBuild_Cache_entryPath(CBuild_Cache *cache, CBuild_CacheKey key, int index, CBuild_String *path)
+{
+    char name[48];
+    snprintf(name, sizeof(name), "/%02x/%014llx%016llx.%d", (unsigned)(key.hi >> 56),
+             (unsigned long long)(key.hi & 0xffffffffffffffull), (unsigned long long)key.lo, index);
+
+    *path = CBuild_String_copy(&cache->dir);
+    CBuild_String_concatCStr(path, name);
+}
+
+/**
+ * @brief Restores the outputs of key from the cache with a reflink or a copy, never a hardlink, so a tool that
+ *        later rewrites an output in place can not change the cache entry, the restored outputs are touched so
+ *        that mtime checks see them as freshly built, the entries keep their own mtime @n
+ *        On a miss the existing outputs are deleted
+ *
+ * @param cache The CBuild_Cache * to fetch from
+ * @param key The key of the outputs
+ * @param outputs The paths of the outputs to restore, for example the object and its depfile
+ * @param outputCount The number of paths in outputs
+ * @return int 1 on a hit, 0 on a miss
+ */
+int CBuild_Cache_fetch(CBuild_Cache *cache, CBuild_CacheKey key, const char *const *outputs, int outputCount)
+{
+    int hit = 1;
+    for (int i = 0; i < outputCount && hit; i++)
+    {
+        CBuild_String entry;
+        CBuild_Cache_entryPath(cache, key, i, &entry);
+        hit = !CBuild_Fs_cloneOrCopy(entry.str, outputs[i]) && !CBuild_Fs_touch(outputs[i]);
+        CBuild_String_deinit(&entry);
+    }
+
+    if (!hit)
+    {
+        for (int i = 0; i < outputCount; i++)
+        {
+            remove(outputs[i]);
+        }
+
+        cache->misses++;
+        return 0;
+    }
+
+    cache->hits++;
+    return 1;
+}
+
+/**
+ * @brief Adds freshly built outputs to the cache under key, the entries are reflinked when the filesystem
+ *        supports it and copied otherwise, they never share an inode with the build tree
+ *
+ * @param cache The CBuild_Cache * to store in
+ * @param key The key the outputs were built for
+ * @param outputs The paths of the built outputs, in the same order as for CBuild_Cache_fetch
+ * @param outputCount The number of paths in outputs
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Cache_store(CBuild_Cache *cache, CBuild_CacheKey key, const char *const *outputs, int outputCount)
+{
+    for (int i = 0; i < outputCount; i++)
+    {
+        CBuild_String entry;
+        CBuild_Cache_entryPath(cache, key, i, &entry);
+
+        // create the fan out directory, its name ends before the last '/'
+        char *slash = strrchr(entry.str, '/');
+        *slash = '\0';
+        CBuild_Fs_mkdir(entry.str);
+        *slash = '/';
+
+        // copy to a temporary name first, so a concurrent fetch never sees a partial entry
+        CBuild_String tmp = CBuild_String_copy(&entry);
+        CBuild_String_concatCStr(&tmp, ".tmp");
+        int failed = CBuild_Fs_cloneOrCopy(outputs[i], tmp.str) || rename(tmp.str, entry.str);
+        if (failed)
+        {
+            fprintf(stderr, "[CBuilder Cache Error] Failed to store %s\n", outputs[i]);
+            remove(tmp.str);
+        }
+
+        CBuild_String_deinit(&tmp);
+        CBuild_String_deinit(&entry);
+        if (failed)
+        {
+            return -1;
+        }
+    }
+
+    cache->stores++;
+    return 0;
+}
+
+/**
+ * @brief Prints the hit, miss and store counters of the cache
+ *
+ * @param cache The CBuild_Cache * to report on
+ */
+void CBuild_Cache_printStats(CBuild_Cache *cache)
+{
+    int lookups = cache->hits + cache->misses;
+    printf("[CBuilder Cache] %d hits, %d misses (%.1f%% hit rate), %d stored\n", cache->hits, cache->misses,
+           lookups ? 100.0 * cache->hits / lookups : 0.0, cache->stores);
+}
+
+#endif // INCLUDED_CBUILDER_CACHE
@@ -0,0 +1,662 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_DB
+#define INCLUDED_CBUILDER_DB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_fs.h"
+#include "cbuilder_deps.h"
+
+#define CBUILD_DB_MAGIC 0x42444243u // "CBDB"
+#define CBUILD_DB_VERSION 1u
+#define CBUILD_DB_HEADER_SIZE 8
+#define CBUILD_DB_APPENDED 0x80000000u // marks a record reference into appendBuf instead of the mapped file
+#define CBUILD_DB_NO_MTIME INT64_MIN    // stat cache value of a missing file
+
+/*
+ * The build database is an append only log of records, a newer record for an output supersedes the older
+ * ones and the log is compacted when most of it is superseded, every record is 8 byte aligned so it can be
+ * used straight from the memory mapped file
+ */
+typedef struct
+{
+    uint32_t size;        // size of the whole record in bytes, multiple of 8
+    uint32_t inputCount;  // number of inputs of the output
+    uint64_t outputHash;  // CBuild_hash of the output path
+    uint64_t commandHash; // hash of the command line the output was built with
+    int64_t outputMtime;  // mtime of the output when it was recorded
+    // int64_t inputMtimes[inputCount]
+    // uint32_t nameOffsets[inputCount + 1], offset of the output path and each input path from the record start
+    // \0 terminated paths, padded to a multiple of 8
+} CBuild_DbRecord;
+
+typedef struct
+{
+    char *path;       // path of the database file
+    FILE *log;        // file the new records are appended to, opened on the first write
+    const char *map;  // contents of the database file at open time
+    size_t mapLen;    // length of map
+    int corrupt;      // set if the file ended in a partial record and must be rewritten
+
+    char *appendBuf;  // records written since open
+    size_t appendLen; // used bytes of appendBuf
+    size_t appendCap; // allocated bytes of appendBuf
+
+    uint64_t *indexHashes; // open addressing table from output hash to the latest record
+    uint32_t *indexRefs;   // offset of the record in map, or in appendBuf with CBUILD_DB_APPENDED, 0 if empty
+    uint32_t indexCap;     // power of 2
+    uint32_t liveCount;    // number of distinct outputs
+    uint32_t deadCount;    // number of superseded records
+
+    uint64_t *statHashes; // open addressing cache of the mtimes read during this run
+    int64_t *statTimes;
+    uint32_t statCap;
+    uint32_t statCount;
+} CBuild_Db;
+
+/**
+ * @brief Hashes a command line argument vector for CBuild_Db_record, the argument boundaries are part of the hash
+ *
+ * @param argv The NULL terminated argument vector
+ * @return uint64_t The hash of the command line
+ */
+uint64_t CBuild_Db_hashArgv(char *const argv[])
+{
+    uint64_t h = 0;
+    for (int i = 0; argv[i] != NULL; i++)
+    {
+        h = CBuild_hash(argv[i], strlen(argv[i]), h + i);
+    }
+
+    return h;
+}
+
+/**
+ * @brief Returns the \0 terminated output path of a record
+ */
+const char *CBuild_DbRecord_output(const CBuild_DbRecord *rec)
+{
+    const uint32_t *offsets = (const uint32_t *)((const int64_t *)(rec + 1) + rec->inputCount);
+    return (const char *)rec + offsets[0];
+}
+
+/**
+ * @brief Returns the \0 terminated path of the i'th input of a record
+ */
+const char *CBuild_DbRecord_input(const CBuild_DbRecord *rec, uint32_t i)
+{
+    const uint32_t *offsets = (const uint32_t *)((const int64_t *)(rec + 1) + rec->inputCount);
+    return (const char *)rec + offsets[i + 1];
+}
+
+/**
+ * @brief Returns the mtime of the i'th input of a record at the time it was recorded
+ */
+int64_t CBuild_DbRecord_inputMtime(const CBuild_DbRecord *rec, uint32_t i)
+{
+    return ((const int64_t *)(rec + 1))[i];
+}
+
+const CBuild_DbRecord *CBuild_Db_deref(CBuild_Db *db, uint32_t ref)
+{
+    if (ref & CBUILD_DB_APPENDED)
+    {
+        return (const CBuild_DbRecord *)(db->appendBuf + (ref & ~CBUILD_DB_APPENDED));
+    }
+
+    return (const CBuild_DbRecord *)(db->map + ref);
+}
+
+// returns the slot of output in the index, either holding it or the empty slot to insert it in,
+// with a NULL output the first empty slot is returned
+uint32_t CBuild_Db_indexSlot(CBuild_Db *db, uint64_t hash, const char *output)
+{
+    uint32_t mask = db->indexCap - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    while (db->indexRefs[slot])
+    {
+        if (output != NULL && db->indexHashes[slot] == hash &&
+            !strcmp(CBuild_DbRecord_output(CBuild_Db_deref(db, db->indexRefs[slot])), output))
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void CBuild_Db_indexInsert(CBuild_Db *db, const CBuild_DbRecord *rec, uint32_t ref)
+{
+    if ((db->liveCount + 1) * 2 > db->indexCap) // keep the load factor under 1/2
+    {
+        uint64_t *oldHashes = db->indexHashes;
+        uint32_t *oldRefs = db->indexRefs;
+        uint32_t oldCap = db->indexCap;
+
+        db->indexCap = oldCap * 2;
+        db->indexHashes = (uint64_t *)malloc(db->indexCap * sizeof(uint64_t));
+        db->indexRefs = (uint32_t *)calloc(db->indexCap, sizeof(uint32_t));
+        for (uint32_t i = 0; i < oldCap; i++)
+        {
+            if (oldRefs[i])
+            {
+                uint32_t slot = CBuild_Db_indexSlot(db, oldHashes[i], NULL); // outputs are distinct already
+                db->indexHashes[slot] = oldHashes[i];
+                db->indexRefs[slot] = oldRefs[i];
+            }
+        }
+
+        free(oldHashes);
+        free(oldRefs);
+    }
+
+    uint32_t slot = CBuild_Db_indexSlot(db, rec->outputHash, CBuild_DbRecord_output(rec));
+    if (db->indexRefs[slot])
+    {
+        db->deadCount++; // superseded by the newer record
+    }
+    else
+    {
+        db->liveCount++;
+    }
+
+    db->indexHashes[slot] = rec->outputHash;
+    db->indexRefs[slot] = ref;
+}
+
+// checks that a record read from disk does not point outside of itself
+int CBuild_Db_validRecord(const CBuild_DbRecord *rec, size_t avail)
+{
+    if (avail < sizeof(CBuild_DbRecord) || rec->size < sizeof(CBuild_DbRecord) || rec->size > avail || rec->size % 8)
+    {
+        return 0;
+    }
+
+    size_t tableEnd = sizeof(CBuild_DbRecord) + rec->inputCount * (sizeof(int64_t) + sizeof(uint32_t)) + sizeof(uint32_t);
+    if (tableEnd >= rec->size || ((const char *)rec)[rec->size - 1] != '\0')
+    {
+        return 0;
+    }
+
+    const uint32_t *offsets = (const uint32_t *)((const int64_t *)(rec + 1) + rec->inputCount);
+    for (uint32_t i = 0; i <= rec->inputCount; i++)
+    {
+        if (offsets[i] < tableEnd || offsets[i] >= rec->size)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#ifdef _WIN32 // no mmap, the file is read into memory instead
+
+void CBuild_Db_map(CBuild_Db *db)
+{
+    CBuild_String data = CBuild_Fs_readFile(db->path);
+    db->map = data.str;
+    db->mapLen = data.str ? data.len : 0;
+}
+
+void CBuild_Db_unmap(CBuild_Db *db)
+{
+    free((char *)db->map);
+}
+
+#elif defined(__linux__) || defined(__APPLE__) || defined(__MACH__) // systems supporting mmap
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+void CBuild_Db_map(CBuild_Db *db)
+{
+    db->map = NULL;
+    db->mapLen = 0;
+
+    int fd = open(db->path, O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat fileStatus;
+    if (!fstat(fd, &fileStatus) && fileStatus.st_size > 0)
+    {
+        void *mem = mmap(NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mem != MAP_FAILED)
+        {
+            db->map = (const char *)mem;
+            db->mapLen = fileStatus.st_size;
+        }
+    }
+
+    close(fd); // the mapping stays valid
+}
+
+void CBuild_Db_unmap(CBuild_Db *db)
+{
+    if (db->map)
+    {
+        munmap((void *)db->map, db->mapLen);
+    }
+}
+
+#else // unsupported system
+#error "[CBuilder Db] Unsupported system, if you know about your system, feel free to define _WIN32 for windows __linux__ or __APPLE__ or __MACH__ for linux and mac systems"
+#endif
+
+/**
+ * @brief Opens the build database at path, the existing records are used straight from the mapped file
+ *        without any allocation per record, a missing or incompatible file starts an empty database
+ *
+ * @param db The CBuild_Db * to open, must be closed with CBuild_Db_close
+ * @param path The path of the database file, for example ./build/.cbuild_db
+ * @return int The number of outputs loaded from the file
+ */
+int CBuild_Db_open(CBuild_Db *db, const char *path)
+{
+    memset(db, 0, sizeof(CBuild_Db));
+    db->path = strdup(path);
+    db->indexCap = 1024;
+    db->indexHashes = (uint64_t *)malloc(db->indexCap * sizeof(uint64_t));
+    db->indexRefs = (uint32_t *)calloc(db->indexCap, sizeof(uint32_t));
+    CBuild_Db_map(db);
+
+    uint32_t header[2] = {0, 0};
+    if (db->mapLen >= CBUILD_DB_HEADER_SIZE)
+    {
+        memcpy(header, db->map, CBUILD_DB_HEADER_SIZE);
+    }
+
+    if (header[0] != CBUILD_DB_MAGIC || header[1] != CBUILD_DB_VERSION)
+    {
+        db->corrupt = db->mapLen > 0; // rewrite unknown files instead of appending to them
+        return 0;
+    }
+
+    size_t offset = CBUILD_DB_HEADER_SIZE;
+    while (offset < db->mapLen)
+    {
+        const CBuild_DbRecord *rec = (const CBuild_DbRecord *)(db->map + offset);
+        if (!CBuild_Db_validRecord(rec, db->mapLen - offset) || offset + rec->size >= CBUILD_DB_APPENDED)
+        {
+            fprintf(stderr, "[CBuilder Db Warning] Ignoring the damaged end of %s\n", path);
+            db->corrupt = 1;
+            break;
+        }
+
+        CBuild_Db_indexInsert(db, rec, (uint32_t)offset);
+        offset += rec->size;
+    }
+
+    return db->liveCount;
+}
+
+/**
+ * @brief Finds the latest record of an output
+ *
+ * @param db The opened CBuild_Db *
+ * @param output The path of the output
+ * @return const CBuild_DbRecord* The record, valid until the next CBuild_Db_record or CBuild_Db_close call, NULL if none
+ */
+const CBuild_DbRecord *CBuild_Db_find(CBuild_Db *db, const char *output)
+{
+    uint64_t hash = CBuild_hash(output, strlen(output), 0);
+    uint32_t slot = CBuild_Db_indexSlot(db, hash, output);
+    return db->indexRefs[slot] ? CBuild_Db_deref(db, db->indexRefs[slot]) : NULL;
+}
+
+// finds the slot of hash in the stat cache
+uint32_t CBuild_Db_statSlot(CBuild_Db *db, uint64_t hash)
+{
+    uint32_t mask = db->statCap - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    while (db->statHashes[slot] && db->statHashes[slot] != hash)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void CBuild_Db_statStore(CBuild_Db *db, uint64_t hash, int64_t mtime)
+{
+    if ((db->statCount + 1) * 2 > db->statCap)
+    {
+        uint64_t *oldHashes = db->statHashes;
+        int64_t *oldTimes = db->statTimes;
+        uint32_t oldCap = db->statCap;
+
+        db->statCap = oldCap ? oldCap * 2 : 1024;
+        db->statHashes = (uint64_t *)calloc(db->statCap, sizeof(uint64_t));
+        db->statTimes = (int64_t *)malloc(db->statCap * sizeof(int64_t));
+        for (uint32_t i = 0; i < oldCap; i++)
+        {
+            if (oldHashes[i])
+            {
+                uint32_t slot = CBuild_Db_statSlot(db, oldHashes[i]);
+                db->statHashes[slot] = oldHashes[i];
+                db->statTimes[slot] = oldTimes[i];
+            }
+        }
+
+        free(oldHashes);
+        free(oldTimes);
+    }
+
+    uint32_t slot = CBuild_Db_statSlot(db, hash);
+    if (!db->statHashes[slot])
+    {
+        db->statCount++;
+    }
+    db->statHashes[slot] = hash;
+    db->statTimes[slot] = mtime;
+}
+
+/**
+ * @brief Same as CBuild_Fs_mtime but every path is only stat'ed once per run, headers shared by many
+ *        outputs are not queried again @n
+ *        Note: paths are only compared by their 64 bit hash
+ *
+ * @param db The opened CBuild_Db *
+ * @param path The path of the file to query
+ * @param mtime The int64_t * to store the modification time in
+ * @return int 0 on success, -1 if the file does not exist
+ */
+int CBuild_Db_mtime(CBuild_Db *db, const char *path, int64_t *mtime)
+{
+    uint64_t hash = CBuild_hash(path, strlen(path), 0) | 1; // 0 marks an empty slot
+    if (db->statCap)
+    {
+        uint32_t slot = CBuild_Db_statSlot(db, hash);
+        if (db->statHashes[slot])
+        {
+            *mtime = db->statTimes[slot];
+            return *mtime == CBUILD_DB_NO_MTIME ? -1 : 0;
+        }
+    }
+
+    if (CBuild_Fs_mtime(path, mtime))
+    {
+        *mtime = CBUILD_DB_NO_MTIME;
+    }
+    CBuild_Db_statStore(db, hash, *mtime);
+
+    return *mtime == CBUILD_DB_NO_MTIME ? -1 : 0;
+}
+
+/**
+ * @brief Checks if output needs to be rebuilt using only the database, without reading any depfile
+ *
+ * @param db The opened CBuild_Db *
+ * @param output The path of the output
+ * @param commandHash The hash of the command line that would build output, see CBuild_Db_hashArgv
+ * @return int 1 if there is no record of output, the command changed, or output or any recorded input changed
+ *         since it was recorded, 0 if it is up to date
+ */
+int CBuild_Db_needsRebuild(CBuild_Db *db, const char *output, uint64_t commandHash)
+{
+    const CBuild_DbRecord *rec = CBuild_Db_find(db, output);
+    if (!rec || rec->commandHash != commandHash)
+    {
+        return 1;
+    }
+
+    int64_t mtime;
+    if (CBuild_Db_mtime(db, output, &mtime) || mtime != rec->outputMtime)
+    {
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < rec->inputCount; i++)
+    {
+        if (CBuild_Db_mtime(db, CBuild_DbRecord_input(rec, i), &mtime) || mtime != CBuild_DbRecord_inputMtime(rec, i))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Records a freshly built output along with its command hash, its inputs and their current mtimes
+ *
+ * @param db The opened CBuild_Db *
+ * @param output The path of the built output
+ * @param commandHash The hash of the command line output was built with, see CBuild_Db_hashArgv
+ * @param inputs The array of input paths, for example the prerequisites of the depfile
+ * @param inputCount The number of paths in inputs
+ * @return int 0 on success, -1 if output does not exist or the record could not be written
+ */
+int CBuild_Db_record(CBuild_Db *db, const char *output, uint64_t commandHash, const char *const *inputs, int inputCount)
+{
+    int64_t outputMtime;
+    if (CBuild_Fs_mtime(output, &outputMtime)) // not cached, the output was just written
+    {
+        fprintf(stderr, "[CBuilder Db Error] Cannot record missing output %s\n", output);
+        return -1;
+    }
+
+    uint32_t outputLen = strlen(output);
+    size_t size = sizeof(CBuild_DbRecord) + inputCount * (sizeof(int64_t) + sizeof(uint32_t)) + sizeof(uint32_t) + outputLen + 1;
+    for (int i = 0; i < inputCount; i++)
+    {
+        size += strlen(inputs[i]) + 1;
+    }
+    size = (size + 7) & ~(size_t)7;
+
+    if (db->appendLen + size >= CBUILD_DB_APPENDED)
+    {
+        fprintf(stderr, "[CBuilder Db Error] Too many records written in one run\n");
+        return -1;
+    }
+
+    if (db->appendLen + size > db->appendCap)
+    {
+        db->appendCap = db->appendCap * 2 > db->appendLen + size ? db->appendCap * 2 : db->appendLen + size + 4096;
+        db->appendBuf = (char *)realloc(db->appendBuf, db->appendCap);
+    }
+
+    char *mem = db->appendBuf + db->appendLen;
+    memset(mem, 0, size);
+
+    CBuild_DbRecord *rec = (CBuild_DbRecord *)mem;
+    rec->size = (uint32_t)size;
+    rec->inputCount = inputCount;
+    rec->outputHash = CBuild_hash(output, outputLen, 0);
+    rec->commandHash = commandHash;
+    rec->outputMtime = outputMtime;
+
+    int64_t *mtimes = (int64_t *)(rec + 1);
+    uint32_t *offsets = (uint32_t *)(mtimes + inputCount);
+    char *names = (char *)(offsets + inputCount + 1);
+
+    offsets[0] = names - mem;
+    memcpy(names, output, outputLen + 1);
+    names += outputLen + 1;
+    for (int i = 0; i < inputCount; i++)
+    {
+        if (CBuild_Db_mtime(db, inputs[i], &mtimes[i]))
+        {
+            mtimes[i] = CBUILD_DB_NO_MTIME; // never matches, so the output is rebuilt next time
+        }
+
+        int len = strlen(inputs[i]);
+        offsets[i + 1] = names - mem;
+        memcpy(names, inputs[i], len + 1);
+        names += len + 1;
+    }
+
+    CBuild_Db_statStore(db, CBuild_hash(output, outputLen, 0) | 1, outputMtime);
+    CBuild_Db_indexInsert(db, rec, (uint32_t)db->appendLen | CBUILD_DB_APPENDED);
+    db->appendLen += size;
+
+    if (db->corrupt) // the whole file is rewritten by CBuild_Db_close
+    {
+        return 0;
+    }
+
+    if (!db->log)
+    {
+        db->log = fopen(db->path, "ab");
+        if (!db->log)
+        {
+            fprintf(stderr, "[CBuilder Db Error] Failed to open %s for writing\n", db->path);
+            return -1;
+        }
+
+        if (db->mapLen == 0)
+        {
+            uint32_t header[2] = {CBUILD_DB_MAGIC, CBUILD_DB_VERSION};
+            fwrite(header, 1, CBUILD_DB_HEADER_SIZE, db->log);
+        }
+    }
+
+    return fwrite(mem, 1, size, db->log) == size ? 0 : -1;
+}
+
+/**
+ * @brief Records a freshly built output with the prerequisites of its depfile as the inputs
+ *
+ * @param db The opened CBuild_Db *
+ * @param output The path of the built output
+ * @param commandHash The hash of the command line output was built with, see CBuild_Db_hashArgv
+ * @param depfile The path of the depfile generated along with output
+ * @return int 0 on success, -1 if the depfile or output are missing or the record could not be written
+ */
+int CBuild_Db_recordDepfile(CBuild_Db *db, const char *output, uint64_t commandHash, const char *depfile)
+{
+    CBuild_Deps deps;
+    if (CBuild_Deps_load(depfile, &deps))
+    {
+        fprintf(stderr, "[CBuilder Db Error] Failed to read depfile %s\n", depfile);
+        return -1;
+    }
+
+    const char **inputs = (const char **)malloc((deps.count ? deps.count : 1) * sizeof(char *));
+    for (int i = 0; i < deps.count; i++)
+    {
+        inputs[i] = CBuild_Deps_get(&deps, i);
+    }
+
+    int retVal = CBuild_Db_record(db, output, commandHash, inputs, deps.count);
+
+    free(inputs);
+    CBuild_Deps_deinit(&deps);
+    return retVal;
+}
+
+/**
+ * @brief Rewrites the database file with only the latest record of every output
+ *
+ * @param db The opened CBuild_Db *
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Db_compact(CBuild_Db *db)
+{
+    size_t pathLen = strlen(db->path);
+    char *tmpPath = (char *)malloc(pathLen + 5);
+    memcpy(tmpPath, db->path, pathLen);
+    memcpy(tmpPath + pathLen, ".tmp", 5);
+
+    FILE *file = fopen(tmpPath, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "[CBuilder Db Error] Failed to open %s for writing\n", tmpPath);
+        free(tmpPath);
+        return -1;
+    }
+
+    uint32_t header[2] = {CBUILD_DB_MAGIC, CBUILD_DB_VERSION};
+    int failed = fwrite(header, 1, CBUILD_DB_HEADER_SIZE, file) != CBUILD_DB_HEADER_SIZE;
+    for (uint32_t i = 0; i < db->indexCap && !failed; i++)
+    {
+        if (db->indexRefs[i])
+        {
+            const CBuild_DbRecord *rec = CBuild_Db_deref(db, db->indexRefs[i]);
+            failed = fwrite(rec, 1, rec->size, file) != rec->size;
+        }
+    }
+
+    failed |= fclose(file) != 0;
+    if (db->log)
+    {
+        fclose(db->log);
+        db->log = NULL;
+    }
+
+    if (!failed)
+    {
+        failed = CBuild_Fs_replace(tmpPath, db->path) != 0;
+    }
+    if (failed)
+    {
+        fprintf(stderr, "[CBuilder Db Error] Failed to rewrite %s\n", db->path);
+        remove(tmpPath);
+    }
+
+    free(tmpPath);
+    return failed ? -1 : 0;
+}
+
+/**
+ * @brief Flushes the new records and closes the database, the file is compacted first if most of it
+ *        is superseded records or it was damaged
+ *
+ * @param db The CBuild_Db * to close
+ */
+void CBuild_Db_close(CBuild_Db *db)
+{
+    if (db->corrupt || (db->deadCount > db->liveCount && db->deadCount >= 64))
+    {
+        CBuild_Db_compact(db);
+    }
+
+    if (db->log)
+    {
+        fclose(db->log);
+    }
+
+    CBuild_Db_unmap(db);
+    free(db->path);
+    free(db->appendBuf);
+    free(db->indexHashes);
+    free(db->indexRefs);
+    free(db->statHashes);
+    free(db->statTimes);
+    memset(db, 0, sizeof(CBuild_Db));
+}
+
+#endif // INCLUDED_CBUILDER_DB
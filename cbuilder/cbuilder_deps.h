@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INCLUDED_CBUILDER_DEPS
+#define INCLUDED_CBUILDER_DEPS
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_fs.h"
+
+typedef struct
+{
+    CBuild_String data; // contents of the depfile, unescaped in place into \0 terminated paths
+    int *offsets;       // offset of each prerequisite path in data.str
+    int count;          // number of prerequisites
+    int cap;            // allocated length of offsets
+} CBuild_Deps;
+
+/**
+ * @brief Parses a Makefile style depfile as generated by gcc/clang -MD/-MMD, the contents of data are
+ *        taken over by deps and decoded in place, so no copies of the paths are made @n
+ *        Handles line continuations, escaped spaces (\ ), escaped # and $$, and multiple rules as
+ *        generated with -MP, only the prerequisites are kept, the targets are skipped
+ *
+ * @param data The CBuild_String holding the depfile contents, owned by deps after this call
+ * @param deps The CBuild_Deps * to store the prerequisites in, must be freed with CBuild_Deps_deinit
+ */
+void CBuild_Deps_parse(CBuild_String data, CBuild_Deps *deps)
+{
+    deps->data = data;
+    deps->offsets = NULL;
+    deps->count = 0;
+    deps->cap = 0;
+
+    char *src = data.str;
+    char *end = data.str + data.len;
+    char *dst = data.str; // decoded output, never ahead of src
+    int inTargets = 1;     // every rule starts with its targets
+
+    while (src < end)
+    {
+        // skip the whitespace and line continuations between paths
+        if (*src == ' ' || *src == '\t' || *src == '\r')
+        {
+            src++;
+            continue;
+        }
+        if (*src == '\\' && src + 1 < end && (src[1] == '\n' || src[1] == '\r'))
+        {
+            src += src[1] == '\r' && src + 2 < end && src[2] == '\n' ? 3 : 2;
+            continue;
+        }
+        if (*src == '\n')
+        {
+            inTargets = 1; // unescaped newline ends the rule
+            src++;
+            continue;
+        }
+
+        // read one path
+        char *path = dst;
+        while (src < end)
+        {
+            char ch = *src;
+            if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+            {
+                break;
+            }
+
+            if (ch == '\\' && src + 1 < end)
+            {
+                char next = src[1];
+                if (next == ' ' || next == '#' || next == '\\')
+                {
+                    *dst++ = next;
+                    src += 2;
+                    continue;
+                }
+                if (next == '\n' || next == '\r')
+                {
+                    break;
+                }
+            }
+            else if (ch == '$' && src + 1 < end && src[1] == '$')
+            {
+                *dst++ = '$';
+                src += 2;
+                continue;
+            }
+            else if (ch == ':' && (src + 1 == end || src[1] == ' ' || src[1] == '\t' || src[1] == '\n' || src[1] == '\r'))
+            {
+                break; // rule separator, a drive letter colon is followed by a slash instead
+            }
+
+            *dst++ = ch;
+            src++;
+        }
+
+        // consume the character that ended the path, so the \0 written below never overwrites unread input
+        int isSeparator = 0;
+        int isNewline = 0;
+        if (src < end)
+        {
+            if (*src == '\\') // line continuation
+            {
+                src += src[1] == '\r' && src + 2 < end && src[2] == '\n' ? 3 : 2;
+            }
+            else
+            {
+                isSeparator = *src == ':';
+                isNewline = *src == '\n';
+                src++;
+            }
+        }
+
+        if (dst != path && !inTargets)
+        {
+            if (deps->count == deps->cap)
+            {
+                deps->cap = deps->cap ? deps->cap * 2 : 16;
+                deps->offsets = (int *)realloc(deps->offsets, deps->cap * sizeof(int));
+            }
+            deps->offsets[deps->count++] = path - data.str;
+        }
+
+        if (isSeparator)
+        {
+            inTargets = 0;
+        }
+        if (isNewline)
+        {
+            inTargets = 1;
+        }
+
+        if (dst == path) // lone separator like "target :"
+        {
+            continue;
+        }
+
+        *dst++ = '\0';
+    }
+}
+
+/**
+ * @brief Reads and parses the depfile at path, see CBuild_Deps_parse
+ *
+ * @param path The path of the depfile
+ * @param deps The CBuild_Deps * to store the prerequisites in, must be freed with CBuild_Deps_deinit
+ * @return int 0 on success, -1 if the depfile could not be read
+ */
+int CBuild_Deps_load(const char *path, CBuild_Deps *deps)
+{
+    CBuild_String data = CBuild_Fs_readFile(path);
+    if (data.str == NULL)
+    {
+        *deps = (CBuild_Deps){{NULL, 0, 0}, NULL, 0, 0};
+        return -1;
+    }
+
+    CBuild_Deps_parse(data, deps);
+    return 0;
+}
+
+/**
+ * @brief Returns the i'th prerequisite path of the parsed depfile
+ *
+ * @param deps The parsed CBuild_Deps *
+ * @param i The index of the prerequisite, must be less than deps->count
+ * @return const char* The \0 terminated path, valid until CBuild_Deps_deinit
+ */
+const char *CBuild_Deps_get(CBuild_Deps *deps, int i)
+{
+    return deps->data.str + deps->offsets[i];
+}
+
+/**
+ * @brief Frees the memory held by the CBuild_Deps
+ *
+ * @param deps The CBuild_Deps * to free
+ */
+void CBuild_Deps_deinit(CBuild_Deps *deps)
+{
+    if (deps->data.str)
+    {
+        CBuild_String_deinit(&deps->data);
+    }
+    free(deps->offsets);
+    deps->offsets = NULL;
+    deps->count = 0;
+    deps->cap = 0;
+}
+
+/**
+ * @brief Checks if output needs to be rebuilt using the prerequisites listed in its depfile, so edits to
+ *        the included headers are also detected, the depfile is expected to be generated along with the output
+ *        by passing -MMD -MF depfile to the compiler
+ *
+ * @param output The path of the generated file
+ * @param depfile The path of the depfile generated with output
+ * @return int 1 if output or the depfile is missing or any prerequisite is newer than output, 0 if it is up to date
+ */
+int CBuild_Deps_needsRebuild(const char *output, const char *depfile)
+{
+    CBuild_Deps deps;
+    if (CBuild_Deps_load(depfile, &deps))
+    {
+        return 1; // no dependency information yet
+    }
+
+    const char **inputs = (const char **)malloc((deps.count ? deps.count : 1) * sizeof(char *));
+    for (int i = 0; i < deps.count; i++)
+    {
+        inputs[i] = CBuild_Deps_get(&deps, i);
+    }
+
+    int retVal = CBuild_Fs_needsRebuild(output, inputs, deps.count);
+
+    free(inputs);
+    CBuild_Deps_deinit(&deps);
+    return retVal;
+}
+
+#endif // INCLUDED_CBUILDER_DEPS
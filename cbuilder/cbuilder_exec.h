@@ -27,6 +27,15 @@ SOFTWARE.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_trace.h"
+#include "cbuilder_jobserver.h"
+
+// returned by CBuild_JobPool_waitAny when a jobserver token arrived before any job finished
+#define CBUILD_JOB_TOKEN -2
 
 int CBuild_system(char *command, const char *successMsg, const char *errorMsg)
 {
@@ -43,4 +52,836 @@ int CBuild_system(char *command, const char *successMsg, const char *errorMsg)
     return retVal;
 }
 
+typedef struct
+{
+    int pid;          // process id of the running job, 0 if the slot is free
+    int id;           // id returned by CBuild_JobPool_submit
+    char *successMsg; // heap copy of the success message
+    char *errorMsg;   // heap copy of the error message
+    int quiet;        // the output and the messages are dropped and a failure is not counted
+    int64_t startNs;  // when the job was started
+    char *traceName;  // heap copy of the name of the job in the trace, NULL while tracing is off
+    char *command;    // heap copy of the command line for the trace, NULL while tracing is off
+    int outFd;        // read end of the pipe capturing stdout and stderr, -1 if not captured or closed
+    CBuild_String output; // captured output, printed in one piece when the job finishes
+} CBuild_Job;
+
+typedef struct
+{
+    int64_t wallNs;   // time from the start of the job to its exit
+    int64_t userNs;   // CPU time spent in user mode, including the processes the job waited for
+    int64_t sysNs;    // CPU time spent in the kernel, including the processes the job waited for
+    int64_t maxRssKb; // peak resident set size in KiB of the largest process of the job
+} CBuild_JobUsage;
+
+typedef struct
+{
+    int id;     // id of the finished job
+    int status; // exit status of the finished job, 128 + signal number if killed by a signal
+} CBuild_JobResult;
+
+typedef struct
+{
+    CBuild_Job *slots; // maxJobs slots for the running jobs
+    int maxJobs;       // maximum number of jobs allowed to run at once
+    int running;       // number of currently occupied slots
+
+    int *statuses;  // exit status of each submitted job indexed by id, -1 while still running
+    CBuild_JobUsage *usages; // resources used by each submitted job indexed by id, zero while still running
+    int jobCount;   // number of jobs submitted so far
+    int statusCap;  // allocated length of statuses
+    int failCount;  // number of jobs finished with a non zero status
+
+    CBuild_Jobserver *jobserver; // shared token pool limiting the parallel jobs, NULL for none
+    char *tokens;                // tokens taken from the jobserver, one per running job after the first
+    int tokenCount;
+    int wantToken;               // CBuild_JobPool_canStart found no token, CBuild_JobPool_waitAny waits for one too
+
+    int capture;             // 1 to capture the output of the jobs, 0 to let them write to the terminal
+    CBuild_JobResult *done;  // jobs reaped together and not returned by CBuild_JobPool_waitAny yet
+    int doneCount;
+
+    const char *label; // name of the next submitted jobs in the trace, NULL to use the program name
+    int quiet;         // 1 to drop the output and the messages of the next submitted jobs and not count their failures
+} CBuild_JobPool;
+
+/**
+ * @brief Returns the number of online processors, used as the default job count of a CBuild_JobPool
+ *
+ * @return int The number of processors, at least 1
+ */
+int CBuild_cpuCount();
+
+/**
+ * @brief Returns a monotonic timestamp for measuring durations, unrelated to the wall clock
+ *
+ * @return int64_t The current time in nanoseconds from an arbitrary start
+ */
+int64_t CBuild_nowNs();
+
+/**
+ * @brief Initialises a CBuild_JobPool able to run upto maxJobs commands at once @n
+ *        The output of every job is captured and printed in one piece when it finishes, so parallel jobs
+ *        never interleave, set pool->capture to 0 to let the jobs write to the terminal directly
+ *
+ * @param pool The CBuild_JobPool * to initialise
+ * @param maxJobs The maximum number of parallel jobs, if <= 0 CBuild_cpuCount() is used
+ */
+void CBuild_JobPool_init(CBuild_JobPool *pool, int maxJobs)
+{
+    if (maxJobs <= 0)
+    {
+        maxJobs = CBuild_cpuCount();
+    }
+
+    pool->slots = (CBuild_Job *)calloc(maxJobs, sizeof(CBuild_Job));
+    pool->maxJobs = maxJobs;
+    pool->running = 0;
+
+    pool->statuses = NULL;
+    pool->usages = NULL;
+    pool->jobCount = 0;
+    pool->statusCap = 0;
+    pool->failCount = 0;
+    pool->label = NULL;
+    pool->quiet = 0;
+
+    pool->jobserver = NULL;
+    pool->tokens = (char *)malloc(maxJobs);
+    pool->tokenCount = 0;
+    pool->wantToken = 0;
+
+    pool->capture = 1;
+    pool->done = (CBuild_JobResult *)malloc(maxJobs * sizeof(CBuild_JobResult));
+    pool->doneCount = 0;
+    for (int i = 0; i < maxJobs; i++)
+    {
+        pool->slots[i].outFd = -1;
+    }
+}
+
+/**
+ * @brief Frees the memory held by the CBuild_JobPool, all the jobs must be waited for before this call
+ *
+ * @param pool The CBuild_JobPool * to free
+ */
+void CBuild_JobPool_deinit(CBuild_JobPool *pool)
+{
+    while (pool->tokenCount > 0)
+    {
+        CBuild_Jobserver_release(pool->jobserver, pool->tokens[--pool->tokenCount]);
+    }
+    free(pool->tokens);
+    pool->tokens = NULL;
+    pool->jobserver = NULL;
+
+    free(pool->slots);
+    free(pool->statuses);
+    free(pool->usages);
+    free(pool->done);
+    pool->done = NULL;
+    pool->doneCount = 0;
+    pool->slots = NULL;
+    pool->statuses = NULL;
+    pool->usages = NULL;
+    pool->maxJobs = 0;
+    pool->running = 0;
+    pool->jobCount = 0;
+    pool->statusCap = 0;
+}
+
+/**
+ * @brief Returns the exit status of the job with the given id
+ *
+ * @param pool The CBuild_JobPool * the job was submitted to
+ * @param id The id returned by CBuild_JobPool_submit
+ * @return int The exit status of the job, -1 if it is still running or the id is invalid
+ */
+int CBuild_JobPool_status(CBuild_JobPool *pool, int id)
+{
+    if (id < 0 || id >= pool->jobCount)
+    {
+        return -1;
+    }
+
+    return pool->statuses[id];
+}
+
+/**
+ * @brief Returns the resources used by a finished job, the CPU times and the peak memory are only measured
+ *        on posix systems, windows reports the wall time alone
+ *
+ * @param pool The CBuild_JobPool * the job was submitted to
+ * @param id The id returned by CBuild_JobPool_submit
+ * @return const CBuild_JobUsage * The usage of the job, valid until the next submit, NULL if it is still
+ *         running or the id is invalid
+ */
+const CBuild_JobUsage *CBuild_JobPool_usage(CBuild_JobPool *pool, int id)
+{
+    if (id < 0 || id >= pool->jobCount || pool->statuses[id] < 0)
+    {
+        return NULL;
+    }
+
+    return &pool->usages[id];
+}
+
+// records a new job id in the status table and returns it
+int CBuild_JobPool_newId(CBuild_JobPool *pool)
+{
+    if (pool->jobCount == pool->statusCap)
+    {
+        pool->statusCap = pool->statusCap ? pool->statusCap * 2 : 64;
+        pool->statuses = (int *)realloc(pool->statuses, pool->statusCap * sizeof(int));
+        pool->usages = (CBuild_JobUsage *)realloc(pool->usages, pool->statusCap * sizeof(CBuild_JobUsage));
+    }
+
+    pool->statuses[pool->jobCount] = -1;
+    pool->usages[pool->jobCount] = (CBuild_JobUsage){0, 0, 0, 0};
+    return pool->jobCount++;
+}
+
+/**
+ * @brief Makes the pool take a token from jobserver for every job it runs in parallel to its first one, so
+ *        the jobs of nested builds together stay within one -j limit, the pool keeps its own maxJobs limit too
+ *
+ * @param pool The CBuild_JobPool * without running jobs
+ * @param jobserver The CBuild_Jobserver * from CBuild_Jobserver_connect or CBuild_Jobserver_create, must
+ *        outlive the pool
+ */
+void CBuild_JobPool_setJobserver(CBuild_JobPool *pool, CBuild_Jobserver *jobserver)
+{
+    pool->jobserver = jobserver;
+}
+
+// gives back the tokens not needed by the running jobs, the first job runs on the implicit token
+void CBuild_JobPool_releaseTokens(CBuild_JobPool *pool)
+{
+    int needed = pool->running > 0 ? pool->running - 1 : 0;
+    while (pool->tokenCount > needed)
+    {
+        CBuild_Jobserver_release(pool->jobserver, pool->tokens[--pool->tokenCount]);
+    }
+}
+
+/**
+ * @brief Checks if one more job may be started now, a free slot is needed and with a jobserver a token, which
+ *        is taken here for the next submit @n
+ *        If it returns 0 the caller waits with CBuild_JobPool_waitAny, which also returns when a token arrives
+ *
+ * @param pool The CBuild_JobPool * to start the job in
+ * @return int 1 if a job can be submitted without waiting, 0 otherwise
+ */
+int CBuild_JobPool_canStart(CBuild_JobPool *pool)
+{
+    pool->wantToken = 0;
+    if (pool->running >= pool->maxJobs)
+    {
+        return 0;
+    }
+    if (!pool->jobserver || pool->running == 0 || pool->tokenCount >= pool->running)
+    {
+        return 1;
+    }
+
+    if (CBuild_Jobserver_tryAcquire(pool->jobserver, &pool->tokens[pool->tokenCount]))
+    {
+        pool->tokenCount++;
+        return 1;
+    }
+
+    pool->wantToken = 1;
+    return 0;
+}
+
+// remembers the start of a job and, while tracing, its name and command line
+void CBuild_JobPool_traceStart(CBuild_JobPool *pool, CBuild_Job *job, const char *program, const char *command)
+{
+    job->startNs = CBuild_nowNs();
+    job->traceName = NULL;
+    job->command = NULL;
+    if (CBuild_Trace_enabled())
+    {
+        job->traceName = strdup(pool->label ? pool->label : program);
+        job->command = strdup(command);
+        CBuild_Trace_counter("running jobs", pool->running + 1);
+    }
+}
+
+// records the exit status and usage of a job and prints its message in the same way as CBuild_system,
+// usage holds the CPU times and memory if the system measured them, may be NULL
+void CBuild_JobPool_finish(CBuild_JobPool *pool, CBuild_Job *job, int status, const CBuild_JobUsage *usage,
+                           CBuild_JobResult *result)
+{
+    CBuild_JobUsage *record = &pool->usages[job->id];
+    if (usage)
+    {
+        *record = *usage;
+    }
+    record->wallNs = CBuild_nowNs() - job->startNs;
+
+    if (job->traceName)
+    {
+        CBuild_Trace_job(job - pool->slots, job->traceName, job->command, job->startNs, status,
+                         record->userNs + record->sysNs, record->maxRssKb);
+        CBuild_Trace_counter("running jobs", pool->running - 1);
+        free(job->traceName);
+        free(job->command);
+        job->traceName = NULL;
+        job->command = NULL;
+    }
+
+    // the output and the message are written at once, so the lines of parallel jobs never mix
+    pool->statuses[job->id] = status;
+    CBuild_String_concatCStr(&job->output, status ? job->errorMsg : job->successMsg);
+    FILE *stream = status ? stderr : stdout;
+    if (job->output.len && !job->quiet)
+    {
+        fwrite(job->output.str, 1, job->output.len, stream);
+        fflush(stream);
+    }
+    CBuild_String_deinit(&job->output);
+    job->output = (CBuild_String){NULL, 0, 0};
+    if (status && !job->quiet)
+    {
+        pool->failCount++;
+    }
+
+    if (result)
+    {
+        result->id = job->id;
+        result->status = status;
+    }
+
+    free(job->successMsg);
+    free(job->errorMsg);
+    job->pid = 0;
+    job->successMsg = NULL;
+    job->errorMsg = NULL;
+    pool->running--;
+    if (pool->jobserver)
+    {
+        CBuild_JobPool_releaseTokens(pool);
+    }
+}
+
+#ifdef _WIN32 // no fork on windows, jobs are run one at a time through system()
+
+#include <windows.h>
+
+int CBuild_cpuCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+int64_t CBuild_nowNs()
+{
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (int64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+           (int64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+}
+
+// converts the return of system() to an exit code, windows returns the exit code itself, -1 if cmd.exe could not
+// be started and a negative NTSTATUS for a crashed process, those would read as still running so they become
+// 127 and 255
+int CBuild_exitCode(int status)
+{
+    if (status == -1)
+    {
+        return 127;
+    }
+
+    return status < 0 ? 255 : status;
+}
+
+int CBuild_JobPool_waitAny(CBuild_JobPool *pool, CBuild_JobResult *result)
+{
+    (void)pool;
+    (void)result;
+    return -1; // jobs are already finished by CBuild_JobPool_submit
+}
+
+int CBuild_JobPool_submit(CBuild_JobPool *pool, const char *command, const char *successMsg, const char *errorMsg)
+{
+    CBuild_Job *job = &pool->slots[0];
+    job->id = CBuild_JobPool_newId(pool);
+    job->successMsg = strdup(successMsg);
+    job->errorMsg = strdup(errorMsg);
+    job->quiet = pool->quiet;
+    CBuild_JobPool_traceStart(pool, job, command, command);
+    pool->running++;
+
+    // the output is not captured here, a quiet job sends it to NUL instead
+    CBuild_String quietCommand = CBuild_String_init(command);
+    if (job->quiet)
+    {
+        CBuild_String_concatCStr(&quietCommand, " >NUL 2>&1");
+    }
+    CBuild_JobPool_finish(pool, job, CBuild_exitCode(system(quietCommand.str)), NULL, NULL);
+    CBuild_String_deinit(&quietCommand);
+    return job->id;
+}
+
+int CBuild_JobPool_submitArgv(CBuild_JobPool *pool, char *const argv[], const char *successMsg, const char *errorMsg)
+{
+    CBuild_String command = CBuild_String_commandArgv(argv, CBUILD_CMD_QUOTE);
+    int id = CBuild_JobPool_submit(pool, command.str, successMsg, errorMsg);
+    CBuild_String_deinit(&command);
+    return id;
+}
+
+int CBuild_spawn(char *const argv[], const char *successMsg, const char *errorMsg)
+{
+    CBuild_String command = CBuild_String_commandArgv(argv, CBUILD_CMD_QUOTE);
+    int retVal = CBuild_system(command.str, successMsg, errorMsg);
+    CBuild_String_deinit(&command);
+    return retVal;
+}
+
+#elif defined(__linux__) || defined(__APPLE__) || defined(__MACH__) // systems supporting posix_spawn
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+
+extern char **environ;
+
+int CBuild_cpuCount()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+int64_t CBuild_nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// converts the rusage of a reaped child, it covers the child and every descendant it waited for, so the
+// compiler proper started by the driver is included
+CBuild_JobUsage CBuild_rusageToUsage(const struct rusage *rusage)
+{
+    CBuild_JobUsage usage;
+    usage.wallNs = 0;
+    usage.userNs = (int64_t)rusage->ru_utime.tv_sec * 1000000000 + (int64_t)rusage->ru_utime.tv_usec * 1000;
+    usage.sysNs = (int64_t)rusage->ru_stime.tv_sec * 1000000000 + (int64_t)rusage->ru_stime.tv_usec * 1000;
+#ifdef __linux__
+    usage.maxRssKb = rusage->ru_maxrss; // KiB on linux
+#else
+    usage.maxRssKb = rusage->ru_maxrss / 1024; // bytes on mac
+#endif
+
+    return usage;
+}
+
+// converts a waitpid status to an exit code, 128 + signal number if the process was killed
+int CBuild_exitCode(int wstatus)
+{
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+}
+
+/**
+ * @brief Starts argv[0] directly without a shell, searching PATH if it does not contain a '/' @n
+ *        Note: glibc implements posix_spawn with vfork semantics (CLONE_VFORK) so the cost does not
+ *        grow with the memory size of the build script
+ *
+ * @param argv The NULL terminated argument vector, argv[0] is the program to run
+ * @return int The pid of the started process, -1 on failure
+ */
+int CBuild_spawnAsync(char *const argv[])
+{
+    fflush(stdout); // do not let the child inherit unflushed output
+    fflush(stderr);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ);
+    if (err)
+    {
+        fprintf(stderr, "[CBuilder Exec Error] Failed to start %s: %s\n", argv[0], strerror(err));
+        return -1;
+    }
+
+    return pid;
+}
+
+/**
+ * @brief Same as CBuild_spawnAsync but stdout and stderr of the process go to a pipe, to be read without
+ *        blocking, so the output of parallel jobs can be printed one job at a time @n
+ *        Note: the compiler sees no terminal then, colored diagnostics need -fdiagnostics-color
+ *
+ * @param argv The NULL terminated argument vector, argv[0] is the program to run
+ * @param outFd Set to the non blocking read end of the pipe, to be closed by the caller
+ * @return int The pid of the started process, -1 on failure
+ */
+int CBuild_spawnCaptured(char *const argv[], int *outFd)
+{
+    fflush(stdout);
+    fflush(stderr);
+
+    int fds[2];
+    if (pipe(fds))
+    {
+        fprintf(stderr, "[CBuilder Exec Error] Failed to create a pipe for %s: %s\n", argv[0], strerror(errno));
+        return -1;
+    }
+
+    // both ends are close on exec so no other child keeps them open, dup2 clears the flag for the child
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err)
+    {
+        close(fds[0]);
+        fprintf(stderr, "[CBuilder Exec Error] Failed to start %s: %s\n", argv[0], strerror(err));
+        return -1;
+    }
+
+    *outFd = fds[0];
+    return pid;
+}
+
+/**
+ * @brief Same as CBuild_system but runs argv directly instead of going through /bin/sh, so no shell
+ *        has to be started and no quoting is needed for the arguments
+ *
+ * @param argv The NULL terminated argument vector, argv[0] is the program to run
+ * @param successMsg The message printed on stdout if the program exits with 0
+ * @param errorMsg The message printed on stderr if the program fails
+ * @return int The exit code of the program, 128 + signal number if killed, -1 if it could not be started
+ */
+int CBuild_spawn(char *const argv[], const char *successMsg, const char *errorMsg)
+{
+    int retVal = -1;
+    int pid = CBuild_spawnAsync(argv);
+    if (pid > 0)
+    {
+        int wstatus;
+        while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR)
+            ;
+        retVal = CBuild_exitCode(wstatus);
+    }
+
+    if (retVal)
+    {
+        fputs(errorMsg, stderr);
+    }
+    else
+    {
+        fputs(successMsg, stdout);
+    }
+
+    return retVal;
+}
+
+// reads the output available on the pipe of a job, the pipe is closed at its end, or with final once the job
+// exited, a process it left in the background may hold the pipe open forever
+void CBuild_JobPool_drain(CBuild_Job *job, int final)
+{
+    char buf[4096];
+    while (job->outFd >= 0)
+    {
+        ssize_t len = read(job->outFd, buf, sizeof(buf));
+        if (len > 0)
+        {
+            CBuild_String_append(&job->output, buf, len);
+            continue;
+        }
+        if (len < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (len == 0 || final || errno != EAGAIN)
+        {
+            close(job->outFd);
+            job->outFd = -1;
+        }
+        break;
+    }
+}
+
+// waits until a job writes output, closes its pipe or exits, one poll for all the pipes so a full pipe never
+// stalls a job while the pool waits on another one, returns 1 if a wanted jobserver token was taken meanwhile
+int CBuild_JobPool_poll(CBuild_JobPool *pool)
+{
+    struct pollfd fds[pool->maxJobs + 1];
+    CBuild_Job *owners[pool->maxJobs];
+    int count = 0, uncaptured = 0;
+    for (int i = 0; i < pool->maxJobs; i++)
+    {
+        CBuild_Job *job = &pool->slots[i];
+        if (job->pid > 0 && job->outFd >= 0)
+        {
+            fds[count] = (struct pollfd){job->outFd, POLLIN, 0};
+            owners[count++] = job;
+        }
+        else if (job->pid > 0)
+        {
+            uncaptured = 1;
+        }
+    }
+
+    int waitToken = pool->jobserver && pool->wantToken;
+    if (count == 0 && !waitToken) // nothing to read, sleep until a child exits without reaping it
+    {
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT) == 0)
+        {
+            for (int i = 0; i < pool->maxJobs; i++)
+            {
+                if (pool->slots[i].pid == info.si_pid)
+                {
+                    return 0;
+                }
+            }
+            // a child of the caller, left for it to reap, the jobs are checked every few milliseconds instead
+            poll(NULL, 0, 5);
+        }
+        return 0;
+    }
+
+    if (waitToken)
+    {
+        fds[count] = (struct pollfd){pool->jobserver->readFd, POLLIN, 0};
+    }
+
+    // the exit of a job is seen as the end of its pipe, jobs without one are checked every few milliseconds
+    if (poll(fds, count + waitToken, uncaptured ? 5 : 100) <= 0)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (fds[i].revents)
+        {
+            CBuild_JobPool_drain(owners[i], 0);
+        }
+    }
+
+    // another client may take the token first, then the wait goes on
+    return waitToken && fds[count].revents && CBuild_JobPool_canStart(pool);
+}
+
+// reaps every job that exited, draining the pipes meanwhile, and finishes them with the failed ones first,
+// returns the number of jobs added to pool->done, CBUILD_JOB_TOKEN if a wanted token came first, -1 on failure
+int CBuild_JobPool_reap(CBuild_JobPool *pool)
+{
+    CBuild_Job *reaped[pool->maxJobs];
+    int statuses[pool->maxJobs];
+    CBuild_JobUsage usages[pool->maxJobs];
+    int count = 0;
+
+    // only the pids of the jobs are waited for, other children of the process keep their exit status
+    while (pool->running > 0)
+    {
+        for (int i = 0; i < pool->maxJobs; i++)
+        {
+            CBuild_Job *job = &pool->slots[i];
+            if (job->pid <= 0)
+            {
+                continue;
+            }
+
+            int wstatus;
+            struct rusage rusage;
+            int pid = wait4(job->pid, &wstatus, WNOHANG, &rusage);
+            if (pid < 0 && errno == EINTR)
+            {
+                i--; // the same job again
+                continue;
+            }
+            if (pid < 0)
+            {
+                if (count)
+                {
+                    break;
+                }
+
+                fprintf(stderr, "[CBuilder Exec Error] wait4 failed: %s\n", strerror(errno));
+                return -1;
+            }
+            if (pid == 0) // still running
+            {
+                continue;
+            }
+
+            CBuild_JobPool_drain(job, 1);
+            job->pid = -1; // reaped, finished below
+            reaped[count] = job;
+            statuses[count] = CBuild_exitCode(wstatus);
+            usages[count++] = CBuild_rusageToUsage(&rusage);
+        }
+
+        if (count)
+        {
+            break;
+        }
+
+        if (pool->jobserver)
+        {
+            CBuild_JobPool_releaseTokens(pool); // tokens taken for jobs that were never submitted
+        }
+        if (CBuild_JobPool_poll(pool))
+        {
+            return CBUILD_JOB_TOKEN;
+        }
+    }
+
+    // failures are printed before the successes reaped together with them
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if ((statuses[i] != 0) == (pass == 0))
+            {
+                CBuild_JobPool_finish(pool, reaped[i], statuses[i], &usages[i], &pool->done[pool->doneCount++]);
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Waits for any one running job of the pool to finish and prints its captured output together with its
+ *        success or error message @n
+ *        Jobs that exit at the same time are reported in one go, the failed ones first
+ *
+ * @param pool The CBuild_JobPool * to wait on
+ * @param result The CBuild_JobResult * to store the id and exit status of the finished job in, may be NULL
+ * @return int The id of the finished job, -1 if no job was running, CBUILD_JOB_TOKEN if CBuild_JobPool_canStart
+ *         was waiting for a jobserver token and took it, result is not set then
+ */
+int CBuild_JobPool_waitAny(CBuild_JobPool *pool, CBuild_JobResult *result)
+{
+    if (pool->doneCount == 0)
+    {
+        int reaped = CBuild_JobPool_reap(pool);
+        if (reaped <= 0)
+        {
+            return reaped == CBUILD_JOB_TOKEN ? CBUILD_JOB_TOKEN : -1;
+        }
+    }
+
+    CBuild_JobResult first = pool->done[0];
+    pool->doneCount--;
+    memmove(pool->done, pool->done + 1, pool->doneCount * sizeof(CBuild_JobResult));
+
+    if (result)
+    {
+        *result = first;
+    }
+    return first.id;
+}
+
+/**
+ * @brief Starts argv in the background without a shell, if all the slots are busy, or no jobserver token
+ *        is available, it first waits for any running job to finish
+ *
+ * @param pool The CBuild_JobPool * to run the program in
+ * @param argv The NULL terminated argument vector, argv[0] is the program to run
+ * @param successMsg The message printed on stdout if the program exits with 0
+ * @param errorMsg The message printed on stderr if the program fails
+ * @return int The id of the job to query with CBuild_JobPool_status, -1 if the program could not be started
+ */
+int CBuild_JobPool_submitArgv(CBuild_JobPool *pool, char *const argv[], const char *successMsg, const char *errorMsg)
+{
+    while (!CBuild_JobPool_canStart(pool))
+    {
+        if (CBuild_JobPool_waitAny(pool, NULL) == -1)
+        {
+            return -1;
+        }
+    }
+
+    CBuild_Job *job = pool->slots;
+    while (job->pid != 0) // atleast one slot is free here
+    {
+        job++;
+    }
+
+    int64_t startNs = CBuild_nowNs();
+    int pid = pool->capture || pool->quiet ? CBuild_spawnCaptured(argv, &job->outFd) : CBuild_spawnAsync(argv);
+    if (pid < 0)
+    {
+        fputs(errorMsg, stderr);
+        return -1;
+    }
+
+    CBuild_String command = {NULL, 0, 0}; // the command line is only built for the trace
+    if (CBuild_Trace_enabled())
+    {
+        command = CBuild_String_commandArgv(argv, CBUILD_CMD_QUOTE);
+    }
+    CBuild_JobPool_traceStart(pool, job, argv[0], command.str);
+    CBuild_String_deinit(&command);
+    job->startNs = startNs; // the span includes starting the process
+
+    job->pid = pid;
+    job->id = CBuild_JobPool_newId(pool);
+    job->successMsg = strdup(successMsg);
+    job->errorMsg = strdup(errorMsg);
+    job->quiet = pool->quiet;
+    pool->running++;
+
+    return job->id;
+}
+
+/**
+ * @brief Starts the command through /bin/sh in the background, if all the slots are busy it first waits
+ *        for any running job to finish, prefer CBuild_JobPool_submitArgv when no shell features are needed
+ *
+ * @param pool The CBuild_JobPool * to run the command in
+ * @param command The shell command to run, copied by the shell so it can be freed right after the call
+ * @param successMsg The message printed on stdout if the command exits with 0
+ * @param errorMsg The message printed on stderr if the command fails
+ * @return int The id of the job to query with CBuild_JobPool_status, -1 if the command could not be started
+ */
+int CBuild_JobPool_submit(CBuild_JobPool *pool, const char *command, const char *successMsg, const char *errorMsg)
+{
+    char *argv[] = {"/bin/sh", "-c", (char *)command, NULL};
+    return CBuild_JobPool_submitArgv(pool, argv, successMsg, errorMsg);
+}
+
+#else // unsupported system
+#error "[CBuilder Exec] Unsupported system, if you know about your system, feel free to define _WIN32 for windows __linux__ or __APPLE__ or __MACH__ for linux and mac systems"
+#endif
+
+/**
+ * @brief Waits for all the running jobs of the pool to finish
+ *
+ * @param pool The CBuild_JobPool * to wait on
+ * @return int The number of jobs that failed since the pool was initialised
+ */
+int CBuild_JobPool_waitAll(CBuild_JobPool *pool)
+{
+    while (CBuild_JobPool_waitAny(pool, NULL) != -1)
+        ;
+
+    return pool->failCount;
+}
+
 #endif // INCLUDED_CBUILDER_EXEC
\ No newline at end of file
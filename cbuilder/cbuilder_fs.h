@@ -29,42 +29,378 @@ SOFTWARE.
 #include <stdint.h>
 
 #include "cbuilder_string.h"
+#include "cbuilder_glob.h"
+#include "cbuilder_arena.h"
+#include "cbuilder_list.h"
+#include "cbuilder_trace.h"
 
 #define CBUILD_FS_DIRMODE_FILES 1
 #define CBUILD_FS_DIRMODE_FOLDERS 1 << 1
 
+#define CBUILD_FS_WALK_RECURSIVE 1 // descend into the sub folders
+#define CBUILD_FS_WALK_STAT 1 << 1 // fill the mtime and size of every entry
+
+#define CBUILD_FS_TYPE_UNKNOWN 0
+#define CBUILD_FS_TYPE_FILE 1
+#define CBUILD_FS_TYPE_FOLDER 2
+#define CBUILD_FS_TYPE_LINK 3 // symbolic links are reported but never followed
+#define CBUILD_FS_TYPE_OTHER 4
+
+typedef struct
+{
+    uint32_t nameOffset; // offset of the \0 terminated path, relative to the walked root, in the names arena
+    uint8_t type;        // one of CBUILD_FS_TYPE_*
+    int64_t mtime;       // modification time in nanoseconds, only with CBUILD_FS_WALK_STAT
+    int64_t size;        // size in bytes, only with CBUILD_FS_WALK_STAT
+} CBuild_FsEntry;
+
+typedef struct
+{
+    CBuild_FsEntry *entries; // contiguous array of the found entries
+    int count;               // number of entries
+    int cap;                 // allocated length of entries
+
+    char *names;      // arena holding the paths of all entries
+    size_t namesLen;  // used bytes of names
+    size_t namesCap;  // allocated bytes of names
+} CBuild_FsList;
+
 CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, const char *delim);
 
+/**
+ * @brief Same as CBuild_Fs_dir, but the listing is an arena string that is freed with the arena
+ *
+ * @param arena The CBuild_Arena * to allocate the listing from, NULL for a heap string like CBuild_Fs_dir
+ * @param path The folder to list
+ * @param mask The glob the entry names must match
+ * @param mode CBUILD_FS_DIRMODE_FILES and/or CBUILD_FS_DIRMODE_FOLDERS
+ * @param delim The delimiter written after every entry
+ * @return CBuild_String The delimited listing, {NULL, 0, 0} if the folder could not be opened
+ */
+CBuild_String CBuild_Fs_dirArena(CBuild_Arena *arena, const char *path, const char *mask, uint8_t mode, const char *delim);
+
+/**
+ * @brief Walks the folder at root and appends its entries to list, unlike CBuild_Fs_dir every entry is
+ *        stored in one contiguous array with all of the paths in a single arena, so the number of allocations
+ *        does not grow with the number of entries, the entry type is taken from the directory listing itself
+ *        whenever the system provides it, without a stat call
+ *
+ * @param root The path of the folder to walk
+ * @param mode CBUILD_FS_DIRMODE_FILES and/or CBUILD_FS_DIRMODE_FOLDERS to select the reported entries
+ * @param flags CBUILD_FS_WALK_RECURSIVE and/or CBUILD_FS_WALK_STAT
+ * @param list The CBuild_FsList * initialised with CBuild_FsList_init to append the entries to
+ * @return int 0 on success, -1 if root could not be opened, unreadable sub folders are skipped with a warning
+ */
+int CBuild_Fs_walk(const char *root, uint8_t mode, int flags, CBuild_FsList *list);
+
+/**
+ * @brief Same as CBuild_Fs_walk but the folders are read by a pool of threads, every folder is a task on the
+ *        deque of the thread that found it and idle threads steal the oldest tasks of the others, this hides the
+ *        latency of network and overlay filesystems, the entries are sorted by path at the end so the result
+ *        does not depend on the thread timing @n
+ *        Note: needs linking with -pthread on older systems
+ *
+ * @param root The path of the folder to walk
+ * @param mode CBUILD_FS_DIRMODE_FILES and/or CBUILD_FS_DIRMODE_FOLDERS to select the reported entries
+ * @param flags CBUILD_FS_WALK_RECURSIVE and/or CBUILD_FS_WALK_STAT
+ * @param threads The number of threads to use, if <= 0 one per processor
+ * @param list The CBuild_FsList * initialised with CBuild_FsList_init to append the entries to, sorted afterwards
+ * @return int 0 on success, -1 if root could not be opened
+ */
+int CBuild_Fs_walkParallel(const char *root, uint8_t mode, int flags, int threads, CBuild_FsList *list);
+
+/**
+ * @brief Reads the last modification time of a file in nanoseconds, with the best resolution the
+ *        filesystem provides
+ *
+ * @param path The path of the file to query
+ * @param mtime The int64_t * to store the modification time in
+ * @return int 0 on success, -1 if the file does not exist or could not be queried
+ */
+int CBuild_Fs_mtime(const char *path, int64_t *mtime);
+
+/**
+ * @brief Creates a directory along with all of its missing parents, like mkdir -p
+ *
+ * @param path The path of the directory to create
+ * @return int 0 on success or if it already exists, -1 on failure
+ */
+int CBuild_Fs_mkdir(const char *path);
+
+/**
+ * @brief Makes dst an independent copy of src, a reflink (copy on write clone) where the filesystem supports it
+ *        and a plain copy otherwise, never a hardlink, so later writes to either file never reach the other,
+ *        dst is replaced
+ *
+ * @param src The path of the existing file
+ * @param dst The path of the file to create
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Fs_cloneOrCopy(const char *src, const char *dst);
+
+/**
+ * @brief Sets the modification time of an existing file to now
+ *
+ * @param path The path of the file
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Fs_touch(const char *path);
+
+/**
+ * @brief Renames src to dst, replacing an existing dst, for files written to a temporary path first @n
+ *        Note: on posix systems the replacement is atomic, a crash leaves either the old or the new dst
+ *
+ * @param src The path of the file to move
+ * @param dst The path to move it to
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Fs_replace(const char *src, const char *dst);
+
+/**
+ * @brief Initialises an empty CBuild_FsList
+ *
+ * @param list The CBuild_FsList * to initialise, must be freed with CBuild_FsList_deinit
+ */
+void CBuild_FsList_init(CBuild_FsList *list)
+{
+    memset(list, 0, sizeof(CBuild_FsList));
+}
+
+/**
+ * @brief Frees the entries and the names arena of the CBuild_FsList
+ *
+ * @param list The CBuild_FsList * to free
+ */
+void CBuild_FsList_deinit(CBuild_FsList *list)
+{
+    free(list->entries);
+    free(list->names);
+    memset(list, 0, sizeof(CBuild_FsList));
+}
+
+/**
+ * @brief Returns the path of the i'th entry relative to the walked root
+ *
+ * @param list The CBuild_FsList * filled by CBuild_Fs_walk
+ * @param i The index of the entry, must be less than list->count
+ * @return const char* The \0 terminated path, valid until the list is modified
+ */
+const char *CBuild_FsList_name(CBuild_FsList *list, int i)
+{
+    return list->names + list->entries[i].nameOffset;
+}
+
+// copies prefix/name into the names arena and returns its offset, prefix must not point into the arena
+uint32_t CBuild_FsList_pushName(CBuild_FsList *list, const char *prefix, size_t prefixLen, const char *name, size_t nameLen)
+{
+    size_t len = prefixLen + (prefixLen ? 1 : 0) + nameLen + 1;
+    if (list->namesLen + len > list->namesCap)
+    {
+        list->namesCap = list->namesCap * 2 > list->namesLen + len ? list->namesCap * 2 : list->namesLen + len + 4096;
+        list->names = (char *)realloc(list->names, list->namesCap);
+    }
+
+    char *dst = list->names + list->namesLen;
+    if (prefixLen)
+    {
+        memcpy(dst, prefix, prefixLen);
+        dst[prefixLen] = '/';
+        dst += prefixLen + 1;
+    }
+    memcpy(dst, name, nameLen);
+    dst[nameLen] = '\0';
+
+    uint32_t offset = (uint32_t)list->namesLen;
+    list->namesLen += len;
+    return offset;
+}
+
+// appends an entry and returns it, the stat fields are zeroed
+CBuild_FsEntry *CBuild_FsList_pushEntry(CBuild_FsList *list, uint32_t nameOffset, uint8_t type)
+{
+    if (list->count == list->cap)
+    {
+        list->cap = list->cap ? list->cap * 2 : 256;
+        list->entries = (CBuild_FsEntry *)realloc(list->entries, list->cap * sizeof(CBuild_FsEntry));
+    }
+
+    CBuild_FsEntry *entry = &list->entries[list->count++];
+    entry->nameOffset = nameOffset;
+    entry->type = type;
+    entry->mtime = 0;
+    entry->size = 0;
+    return entry;
+}
+
+/**
+ * @brief Appends all the entries of src to dst, the names are copied into the arena of dst
+ *
+ * @param dst The CBuild_FsList * to append to
+ * @param src The CBuild_FsList * to append from, left unchanged
+ */
+void CBuild_FsList_append(CBuild_FsList *dst, CBuild_FsList *src)
+{
+    if (dst->namesLen + src->namesLen > dst->namesCap)
+    {
+        dst->namesCap = dst->namesLen + src->namesLen;
+        dst->names = (char *)realloc(dst->names, dst->namesCap);
+    }
+    if (dst->count + src->count > dst->cap)
+    {
+        dst->cap = dst->count + src->count;
+        dst->entries = (CBuild_FsEntry *)realloc(dst->entries, dst->cap * sizeof(CBuild_FsEntry));
+    }
+
+    memcpy(dst->names + dst->namesLen, src->names, src->namesLen);
+    for (int i = 0; i < src->count; i++)
+    {
+        dst->entries[dst->count + i] = src->entries[i];
+        dst->entries[dst->count + i].nameOffset += (uint32_t)dst->namesLen;
+    }
+
+    dst->namesLen += src->namesLen;
+    dst->count += src->count;
+}
+
+// merge sort of entries by name, tmp must hold count entries
+void CBuild_FsList_sortRange(CBuild_FsEntry *entries, CBuild_FsEntry *tmp, int count, const char *names)
+{
+    if (count <= 16) // insertion sort for the small ranges
+    {
+        for (int i = 1; i < count; i++)
+        {
+            CBuild_FsEntry entry = entries[i];
+            int j = i;
+            while (j > 0 && strcmp(names + entries[j - 1].nameOffset, names + entry.nameOffset) > 0)
+            {
+                entries[j] = entries[j - 1];
+                j--;
+            }
+            entries[j] = entry;
+        }
+        return;
+    }
+
+    int half = count / 2;
+    CBuild_FsList_sortRange(entries, tmp, half, names);
+    CBuild_FsList_sortRange(entries + half, tmp, count - half, names);
+
+    int i = 0, j = half, k = 0;
+    while (i < half && j < count)
+    {
+        if (strcmp(names + entries[j].nameOffset, names + entries[i].nameOffset) < 0)
+        {
+            tmp[k++] = entries[j++];
+        }
+        else
+        {
+            tmp[k++] = entries[i++];
+        }
+    }
+    while (i < half)
+    {
+        tmp[k++] = entries[i++];
+    }
+    // the rest of the right half is already in place
+    memcpy(entries, tmp, k * sizeof(CBuild_FsEntry));
+}
+
+/**
+ * @brief Sorts the entries of the list by their path, the order of equal paths is kept
+ *
+ * @param list The CBuild_FsList * to sort
+ */
+void CBuild_FsList_sort(CBuild_FsList *list)
+{
+    if (list->count < 2)
+    {
+        return;
+    }
+
+    CBuild_FsEntry *tmp = (CBuild_FsEntry *)malloc(list->count * sizeof(CBuild_FsEntry));
+    CBuild_FsList_sortRange(list->entries, tmp, list->count, list->names);
+    free(tmp);
+}
+
+/**
+ * @brief Removes the entries whose path does not match the pattern set, in place and without allocating
+ *
+ * @param list The CBuild_FsList * to filter, the names arena is left as is
+ * @param glob The compiled CBuild_Glob * to match the paths relative to the walked root against
+ */
+void CBuild_FsList_filter(CBuild_FsList *list, const CBuild_Glob *glob)
+{
+    int kept = 0;
+    for (int i = 0; i < list->count; i++)
+    {
+        if (CBuild_Glob_match(glob, list->names + list->entries[i].nameOffset))
+        {
+            list->entries[kept++] = list->entries[i];
+        }
+    }
+
+    list->count = kept;
+}
+
+// compiles the mask of CBuild_Fs_dir, a leading / is ignored and the dos style *.* also matches names without a dot
+void CBuild_Fs_compileMask(CBuild_Glob *glob, const char *mask)
+{
+    if (mask[0] == '/')
+    {
+        mask++;
+    }
+
+    CBuild_Glob_init(glob);
+    if (mask[0] != '\0' && strcmp(mask, "*.*") && strcmp(mask, "*"))
+    {
+        CBuild_Glob_add(glob, mask, 0);
+    }
+}
+
+// stack of the name offsets of the folders still to be walked
+typedef struct
+{
+    uint32_t *offsets;
+    int count;
+    int cap;
+} CBuild_FsWalkStack;
+
+void CBuild_FsWalkStack_push(CBuild_FsWalkStack *stack, uint32_t offset)
+{
+    if (stack->count == stack->cap)
+    {
+        stack->cap = stack->cap ? stack->cap * 2 : 64;
+        stack->offsets = (uint32_t *)realloc(stack->offsets, stack->cap * sizeof(uint32_t));
+    }
+
+    stack->offsets[stack->count++] = offset;
+}
+
 #ifdef _WIN32 // systems with win api
 
 #include <windows.h>
 
-CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, const char *delim)
+CBuild_String CBuild_Fs_dirArena(CBuild_Arena *arena, const char *path, const char *mask, uint8_t mode, const char *delim)
 {
     WIN32_FIND_DATAA fdFile;
     HANDLE hFind = NULL;
 
-    if (mask[0] == '\0') // make sure mask is not error type
-    {
-        mask = "*.*";
-    }
-
     int pathLen = strlen(path);
-    int maskLen = strlen(mask);
 
-    char cpyPath[pathLen + maskLen + 1];
+    char cpyPath[pathLen + 3];
     memcpy(cpyPath, path, pathLen);
-    memcpy(cpyPath + pathLen, mask, maskLen + 1);
-
-    CBuild_String output = CBuild_String_init("");
+    memcpy(cpyPath + pathLen, "/*", 3); // every entry, the mask is matched below
 
     if ((hFind = FindFirstFileA(cpyPath, &fdFile)) == INVALID_HANDLE_VALUE)
     {
         fprintf(stderr, "[CBuilder FS Error] Failed to open path %s\n", cpyPath);
-        CBuild_String_deinit(&output);
         return (CBuild_String){NULL, 0, 0};
     }
 
+    CBuild_Glob glob;
+    CBuild_Fs_compileMask(&glob, mask);
+    CBuild_String output = CBuild_String_initArena(arena, "");
+
     do
     {
         if ((fdFile.cFileName[0] == '.') && (fdFile.cFileName[1] == '\0' || fdFile.cFileName[1] == '.'))
@@ -72,38 +408,223 @@ CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, co
             continue;
         }
 
+        if (!CBuild_Glob_match(&glob, fdFile.cFileName))
+        {
+            continue;
+        }
+
         if ((mode & CBUILD_FS_DIRMODE_FOLDERS) && (fdFile.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
         {
-            CBuild_String_concatCStr(&output, fdFile.cFileName);
+            CBuild_String_concatCStrArena(arena, &output, fdFile.cFileName);
         }
         else if (mode & CBUILD_FS_DIRMODE_FILES && !(fdFile.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
         {
-            CBuild_String_concatCStr(&output, fdFile.cFileName);
+            CBuild_String_concatCStrArena(arena, &output, fdFile.cFileName);
+        }
+        else
+        {
+            continue;
         }
 
-        CBuild_String_concatCStr(&output, (char *)delim); // add the ending delimeter
+        CBuild_String_concatCStrArena(arena, &output, delim); // add the ending delimeter
     } while (FindNextFileA(hFind, &fdFile));
 
     FindClose(hFind); // cleanup
+    CBuild_Glob_deinit(&glob);
 
     return output;
 }
 
+int CBuild_Fs_mtime(const char *path, int64_t *mtime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attr))
+    {
+        return -1;
+    }
+
+    // FILETIME counts 100ns intervals
+    *mtime = (((int64_t)attr.ftLastWriteTime.dwHighDateTime << 32) | attr.ftLastWriteTime.dwLowDateTime) * 100;
+    return 0;
+}
+
+int CBuild_Fs_mkdir(const char *path)
+{
+    int len = strlen(path);
+    char cpyPath[len + 1];
+    memcpy(cpyPath, path, len + 1);
+
+    for (int i = 1; i <= len; i++) // create every parent on the way
+    {
+        if (cpyPath[i] != '/' && cpyPath[i] != '\\' && cpyPath[i] != '\0')
+        {
+            continue;
+        }
+
+        char ch = cpyPath[i];
+        cpyPath[i] = '\0';
+        if (!CreateDirectoryA(cpyPath, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+        {
+            fprintf(stderr, "[CBuilder FS Error] Failed to create directory %s\n", cpyPath);
+            return -1;
+        }
+        cpyPath[i] = ch;
+    }
+
+    return 0;
+}
+
+int CBuild_Fs_cloneOrCopy(const char *src, const char *dst)
+{
+    DeleteFileA(dst);
+    return CopyFileA(src, dst, FALSE) ? 0 : -1;
+}
+
+int CBuild_Fs_replace(const char *src, const char *dst)
+{
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) ? 0 : -1; // rename does not replace on windows
+}
+
+int CBuild_Fs_touch(const char *path)
+{
+    HANDLE file = CreateFileA(path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    int retVal = SetFileTime(file, NULL, NULL, &now) ? 0 : -1;
+    CloseHandle(file);
+    return retVal;
+}
+
+int CBuild_Fs_walkFolder(const char *path, int prefixOffset, uint8_t mode, int flags, CBuild_FsList *list, CBuild_FsWalkStack *folders)
+{
+    int pathLen = strlen(path);
+    char pattern[pathLen + 3];
+    memcpy(pattern, path, pathLen);
+    memcpy(pattern + pathLen, "\\*", 3);
+
+    WIN32_FIND_DATAA fdFile;
+    HANDLE hFind = FindFirstFileA(pattern, &fdFile);
+    if (hFind == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "[CBuilder FS %s] Failed to open path %s\n", prefixOffset < 0 ? "Error" : "Warning", path);
+        return -1;
+    }
+
+    const char *prefix = prefixOffset < 0 ? "" : path + prefixOffset;
+    size_t prefixLen = strlen(prefix);
+    do
+    {
+        if ((fdFile.cFileName[0] == '.') && (fdFile.cFileName[1] == '\0' || (fdFile.cFileName[1] == '.' && fdFile.cFileName[2] == '\0')))
+        {
+            continue;
+        }
+
+        uint8_t type = CBUILD_FS_TYPE_FILE;
+        if (fdFile.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+        {
+            type = CBUILD_FS_TYPE_LINK;
+        }
+        else if (fdFile.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            type = CBUILD_FS_TYPE_FOLDER;
+        }
+
+        int report = type == CBUILD_FS_TYPE_FOLDER ? mode & CBUILD_FS_DIRMODE_FOLDERS : mode & CBUILD_FS_DIRMODE_FILES;
+        int descend = type == CBUILD_FS_TYPE_FOLDER && (flags & CBUILD_FS_WALK_RECURSIVE);
+        if (!report && !descend)
+        {
+            continue;
+        }
+
+        uint32_t name = CBuild_FsList_pushName(list, prefix, prefixLen, fdFile.cFileName, strlen(fdFile.cFileName));
+        if (descend)
+        {
+            CBuild_FsWalkStack_push(folders, name);
+        }
+
+        if (report)
+        {
+            CBuild_FsEntry *entry = CBuild_FsList_pushEntry(list, name, type);
+            if (flags & CBUILD_FS_WALK_STAT)
+            {
+                entry->mtime = (((int64_t)fdFile.ftLastWriteTime.dwHighDateTime << 32) | fdFile.ftLastWriteTime.dwLowDateTime) * 100;
+                entry->size = ((int64_t)fdFile.nFileSizeHigh << 32) | fdFile.nFileSizeLow;
+            }
+        }
+    } while (FindNextFileA(hFind, &fdFile));
+
+    FindClose(hFind);
+    return 0;
+}
+
 #elif defined(__linux__) || defined(__APPLE__) || defined(__MACH__) // systems supporting dirent.h
 
 #include <dirent.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
-CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, const char *delim)
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+// converts the st_mode of a stat call to one of CBUILD_FS_TYPE_*
+uint8_t CBuild_Fs_statType(mode_t mode)
 {
-    if (mask[0] == '/') // if first character is / then ignore
+    if (S_ISREG(mode))
     {
-        mask++;
+        return CBUILD_FS_TYPE_FILE;
     }
+    if (S_ISDIR(mode))
+    {
+        return CBUILD_FS_TYPE_FOLDER;
+    }
+    if (S_ISLNK(mode))
+    {
+        return CBUILD_FS_TYPE_LINK;
+    }
+
+    return CBUILD_FS_TYPE_OTHER;
+}
 
+// returns the type of a directory entry, only calls stat if the filesystem does not report d_type
+uint8_t CBuild_Fs_direntType(DIR *dir, struct dirent *dirEntry)
+{
+#ifdef _DIRENT_HAVE_D_TYPE
+    switch (dirEntry->d_type)
+    {
+    case DT_REG:
+        return CBUILD_FS_TYPE_FILE;
+    case DT_DIR:
+        return CBUILD_FS_TYPE_FOLDER;
+    case DT_LNK:
+        return CBUILD_FS_TYPE_LINK;
+    case DT_UNKNOWN:
+        break;
+    default:
+        return CBUILD_FS_TYPE_OTHER;
+    }
+#endif
+
+    struct stat fileStatus;
+    if (fstatat(dirfd(dir), dirEntry->d_name, &fileStatus, AT_SYMLINK_NOFOLLOW))
+    {
+        return CBUILD_FS_TYPE_UNKNOWN;
+    }
+
+    return CBuild_Fs_statType(fileStatus.st_mode);
+}
+
+CBuild_String CBuild_Fs_dirArena(CBuild_Arena *arena, const char *path, const char *mask, uint8_t mode, const char *delim)
+{
     struct dirent *dirEntry;
     DIR *dir;
-    struct stat fileStatus;
 
     dir = opendir(path);
     if (!dir)
@@ -112,7 +633,9 @@ CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, co
         return (CBuild_String){NULL, 0, 0}; // return nothing
     }
 
-    CBuild_String output = CBuild_String_init("");
+    CBuild_Glob glob; // compiled once, matched against every entry
+    CBuild_Fs_compileMask(&glob, mask);
+    CBuild_String output = CBuild_String_initArena(arena, "");
 
     while ((dirEntry = readdir(dir)) != NULL)
     {
@@ -122,64 +645,589 @@ CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, co
             continue;
         }
 
-        char *dotPos = strchr(mask, '.') + 1;
-        if (!dotPos)
+        if (!CBuild_Glob_match(&glob, dirEntry->d_name))
         {
-            dotPos = (char *)mask + strlen(mask);
+            continue;
         }
 
-        char *fileExt = strrchr(dirEntry->d_name, '.') + 1;
-        int fileNameLen = fileExt - dirEntry->d_name - 1;
-        if (fileExt == NULL + 1)
+        int isFolder = CBuild_Fs_direntType(dir, dirEntry) == CBUILD_FS_TYPE_FOLDER; // d_type, no stat needed
+        if ((mode & CBUILD_FS_DIRMODE_FOLDERS) && isFolder)
         {
-            int dirLen = strlen(dirEntry->d_name);
-            fileExt = dirEntry->d_name + dirLen;
-            fileNameLen = dirLen;
+            CBuild_String_concatCStrArena(arena, &output, dirEntry->d_name);
         }
-        
-        char *fileName;
-        if (fileExt == dirEntry->d_name + 1)
+        else if ((mode & CBUILD_FS_DIRMODE_FILES) && !isFolder)
         {
-            fileName = "";
+            CBuild_String_concatCStrArena(arena, &output, dirEntry->d_name);
         }
         else
         {
-            fileName = (char *)alloca(fileNameLen + 1);
-            memcpy(fileName, dirEntry->d_name, fileNameLen);
-            fileName[fileNameLen] = '\0';
+            continue;
         }
-        
-        int maskLen = strlen(mask);
-        if (mask[0] != '*' && strncmp(mask, fileName, fileNameLen - 1))
+
+        CBuild_String_concatCStrArena(arena, &output, delim);
+    }
+
+    closedir(dir); // cleanup
+    CBuild_Glob_deinit(&glob);
+
+    return output;
+}
+
+int CBuild_Fs_mtime(const char *path, int64_t *mtime)
+{
+    struct stat fileStatus;
+    if (stat(path, &fileStatus))
+    {
+        return -1;
+    }
+
+#if defined(__APPLE__) || defined(__MACH__)
+    *mtime = (int64_t)fileStatus.st_mtimespec.tv_sec * 1000000000 + fileStatus.st_mtimespec.tv_nsec;
+#else
+    *mtime = (int64_t)fileStatus.st_mtim.tv_sec * 1000000000 + fileStatus.st_mtim.tv_nsec;
+#endif
+    return 0;
+}
+
+int CBuild_Fs_mkdir(const char *path)
+{
+    int len = strlen(path);
+    char cpyPath[len + 1];
+    memcpy(cpyPath, path, len + 1);
+
+    for (int i = 1; i <= len; i++) // create every parent on the way
+    {
+        if (cpyPath[i] != '/' && cpyPath[i] != '\0')
         {
             continue;
         }
 
-        if (dotPos[0] != '*' && strcmp(dotPos, fileExt))
+        char ch = cpyPath[i];
+        cpyPath[i] = '\0';
+        if (mkdir(cpyPath, 0777) && errno != EEXIST)
         {
-            continue;
+            fprintf(stderr, "[CBuilder FS Error] Failed to create directory %s: %s\n", cpyPath, strerror(errno));
+            return -1;
         }
+        cpyPath[i] = ch;
+    }
+
+    return 0;
+}
+
+int CBuild_Fs_cloneOrCopy(const char *src, const char *dst)
+{
+    unlink(dst); // a new inode, even if dst was a hardlink of another file
+    int srcFd = open(src, O_RDONLY);
+    if (srcFd < 0)
+    {
+        return -1;
+    }
 
-        stat(dirEntry->d_name, &fileStatus);
-        if ((mode & CBUILD_FS_DIRMODE_FOLDERS) && (fileStatus.st_mode & S_IFDIR))
+    struct stat srcStat;
+    int dstFd = fstat(srcFd, &srcStat) ? -1 : open(dst, O_WRONLY | O_CREAT | O_TRUNC, srcStat.st_mode & 0777);
+    if (dstFd < 0)
+    {
+        close(srcFd);
+        return -1;
+    }
+
+    int retVal = 0;
+#ifdef FICLONE
+    if (ioctl(dstFd, FICLONE, srcFd)) // not on the same copy on write filesystem, copy the data
+#endif
+    {
+        char buf[65536];
+        ssize_t len;
+        while ((len = read(srcFd, buf, sizeof(buf))) > 0)
         {
-            CBuild_String_concatCStr(&output, dirEntry->d_name);
+            if (write(dstFd, buf, len) != len)
+            {
+                retVal = -1;
+                break;
+            }
         }
-        else if ((mode & CBUILD_FS_DIRMODE_FILES) && !(fileStatus.st_mode & S_IFDIR))
+        if (len < 0)
         {
-            CBuild_String_concatCStr(&output, dirEntry->d_name);
+            retVal = -1;
         }
+    }
 
-        CBuild_String_concatCStr(&output, (char *)delim);
+    close(srcFd);
+    close(dstFd);
+    return retVal;
+}
+
+int CBuild_Fs_touch(const char *path)
+{
+    return utimensat(AT_FDCWD, path, NULL, 0) ? -1 : 0;
+}
+
+int CBuild_Fs_replace(const char *src, const char *dst)
+{
+    return rename(src, dst) ? -1 : 0;
+}
+
+int CBuild_Fs_walkFolder(const char *path, int prefixOffset, uint8_t mode, int flags, CBuild_FsList *list, CBuild_FsWalkStack *folders)
+{
+    DIR *dir = opendir(path);
+    if (!dir)
+    {
+        fprintf(stderr, "[CBuilder FS %s] %s: %s\n", prefixOffset < 0 ? "Error" : "Warning", path, strerror(errno));
+        return -1;
     }
 
-    closedir(dir); // cleanup
+    const char *prefix = prefixOffset < 0 ? "" : path + prefixOffset;
+    size_t prefixLen = strlen(prefix);
+    struct dirent *dirEntry;
+    while ((dirEntry = readdir(dir)) != NULL)
+    {
+        // ignore . and .. entries
+        if ((dirEntry->d_name[0] == '.') && (dirEntry->d_name[1] == '\0' || (dirEntry->d_name[1] == '.' && dirEntry->d_name[2] == '\0')))
+        {
+            continue;
+        }
 
-    return output;
+        uint8_t type = CBuild_Fs_direntType(dir, dirEntry);
+        int report = type == CBUILD_FS_TYPE_FOLDER ? mode & CBUILD_FS_DIRMODE_FOLDERS : mode & CBUILD_FS_DIRMODE_FILES;
+        int descend = type == CBUILD_FS_TYPE_FOLDER && (flags & CBUILD_FS_WALK_RECURSIVE);
+        if (!report && !descend)
+        {
+            continue;
+        }
+
+        uint32_t name = CBuild_FsList_pushName(list, prefix, prefixLen, dirEntry->d_name, strlen(dirEntry->d_name));
+        if (descend)
+        {
+            CBuild_FsWalkStack_push(folders, name);
+        }
+
+        if (report)
+        {
+            CBuild_FsEntry *entry = CBuild_FsList_pushEntry(list, name, type);
+            struct stat fileStatus;
+            if ((flags & CBUILD_FS_WALK_STAT) && !fstatat(dirfd(dir), dirEntry->d_name, &fileStatus, AT_SYMLINK_NOFOLLOW))
+            {
+#if defined(__APPLE__) || defined(__MACH__)
+                entry->mtime = (int64_t)fileStatus.st_mtimespec.tv_sec * 1000000000 + fileStatus.st_mtimespec.tv_nsec;
+#else
+                entry->mtime = (int64_t)fileStatus.st_mtim.tv_sec * 1000000000 + fileStatus.st_mtim.tv_nsec;
+#endif
+                entry->size = fileStatus.st_size;
+            }
+        }
+    }
+
+    closedir(dir);
+    return 0;
 }
 
 #else // unsupported system
 #error "[CBuilder FS] Unsupported system, if you know about your system, feel free to define _WIN32 for windows __linux__ or __APPLE__ or __MACH__ for linux and mac systems"
 #endif
 
+int CBuild_Fs_walk(const char *root, uint8_t mode, int flags, CBuild_FsList *list)
+{
+    CBuild_FsWalkStack folders = {NULL, 0, 0};
+    if (CBuild_Fs_walkFolder(root, -1, mode, flags, list, &folders))
+    {
+        return -1;
+    }
+
+    int rootLen = strlen(root);
+    CBuild_String path = CBuild_String_init(root);
+    CBuild_String_concatCStr(&path, "/");
+    while (folders.count)
+    {
+        // root/folder, the folder name is copied out of the arena as the arena grows during the walk
+        path.len = rootLen + 1;
+        path.str[path.len] = '\0';
+        CBuild_String_concatCStr(&path, list->names + folders.offsets[--folders.count]);
+
+        CBuild_Fs_walkFolder(path.str, rootLen + 1, mode, flags, list, &folders);
+    }
+
+    free(folders.offsets);
+    CBuild_String_deinit(&path);
+    return 0;
+}
+
+#ifdef _WIN32 // no pthreads, walk on the calling thread
+
+int CBuild_Fs_walkParallel(const char *root, uint8_t mode, int flags, int threads, CBuild_FsList *list)
+{
+    int retVal = CBuild_Fs_walk(root, mode, flags, list);
+    CBuild_FsList_sort(list);
+    return retVal;
+}
+
+#else
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// deque of the relative folder paths still to be walked, the owner works on the newest and thieves take the oldest
+typedef struct
+{
+    pthread_mutex_t lock;
+    char **tasks; // heap allocated paths in [head, tail)
+    int head;
+    int tail;
+    int cap;
+} CBuild_FsDeque;
+
+typedef struct
+{
+    const char *root;
+    int rootLen;
+    uint8_t mode;
+    int flags;
+    int threads;
+
+    CBuild_FsDeque *deques; // one per thread
+    CBuild_FsList *lists;   // one per thread, merged at the end
+
+    atomic_int pending;     // folders queued or being walked
+    atomic_uint version;    // bumped on every new task, so idle threads do not miss one
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCond;
+    int done;
+} CBuild_FsScan;
+
+typedef struct
+{
+    CBuild_FsScan *scan;
+    int index;
+} CBuild_FsScanWorker;
+
+void CBuild_FsDeque_push(CBuild_FsDeque *deque, char *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->cap)
+    {
+        if (deque->head > deque->cap / 2) // reuse the space freed by thieves
+        {
+            memmove(deque->tasks, deque->tasks + deque->head, (deque->tail - deque->head) * sizeof(char *));
+        }
+        else
+        {
+            deque->cap = deque->cap ? deque->cap * 2 : 64;
+            char **tasks = (char **)malloc(deque->cap * sizeof(char *));
+            memcpy(tasks, deque->tasks + deque->head, (deque->tail - deque->head) * sizeof(char *));
+            free(deque->tasks);
+            deque->tasks = tasks;
+        }
+        deque->tail -= deque->head;
+        deque->head = 0;
+    }
+
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+char *CBuild_FsDeque_take(CBuild_FsDeque *deque, int steal)
+{
+    char *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail)
+    {
+        task = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+// queues the folders found by the last CBuild_Fs_walkFolder call on the deque of the worker
+void CBuild_FsScan_pushFolders(CBuild_FsScan *scan, int index, CBuild_FsWalkStack *folders)
+{
+    if (!folders->count)
+    {
+        return;
+    }
+
+    CBuild_FsList *list = &scan->lists[index];
+    atomic_fetch_add(&scan->pending, folders->count);
+    for (int i = 0; i < folders->count; i++)
+    {
+        CBuild_FsDeque_push(&scan->deques[index], strdup(list->names + folders->offsets[i]));
+    }
+    folders->count = 0;
+
+    pthread_mutex_lock(&scan->idleLock);
+    atomic_fetch_add(&scan->version, 1);
+    pthread_cond_broadcast(&scan->idleCond);
+    pthread_mutex_unlock(&scan->idleLock);
+}
+
+void *CBuild_FsScan_worker(void *arg)
+{
+    CBuild_FsScan *scan = ((CBuild_FsScanWorker *)arg)->scan;
+    int index = ((CBuild_FsScanWorker *)arg)->index;
+
+    CBuild_FsWalkStack folders = {NULL, 0, 0};
+    CBuild_String path = CBuild_String_init(scan->root);
+    CBuild_String_concatCStr(&path, "/");
+
+    while (1)
+    {
+        unsigned int seen = atomic_load(&scan->version);
+
+        char *task = CBuild_FsDeque_take(&scan->deques[index], 0);
+        for (int i = 1; !task && i < scan->threads; i++)
+        {
+            task = CBuild_FsDeque_take(&scan->deques[(index + i) % scan->threads], 1);
+        }
+
+        if (task)
+        {
+            path.len = scan->rootLen + 1;
+            path.str[path.len] = '\0';
+            CBuild_String_concatCStr(&path, task);
+            free(task);
+
+            CBuild_Fs_walkFolder(path.str, scan->rootLen + 1, scan->mode, scan->flags, &scan->lists[index], &folders);
+            CBuild_FsScan_pushFolders(scan, index, &folders);
+
+            if (atomic_fetch_sub(&scan->pending, 1) == 1) // that was the last folder
+            {
+                pthread_mutex_lock(&scan->idleLock);
+                scan->done = 1;
+                pthread_cond_broadcast(&scan->idleCond);
+                pthread_mutex_unlock(&scan->idleLock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&scan->idleLock);
+        while (!scan->done && atomic_load(&scan->version) == seen)
+        {
+            pthread_cond_wait(&scan->idleCond, &scan->idleLock);
+        }
+        int done = scan->done;
+        pthread_mutex_unlock(&scan->idleLock);
+
+        if (done)
+        {
+            break;
+        }
+    }
+
+    free(folders.offsets);
+    CBuild_String_deinit(&path);
+    CBuild_String_releasePool(); // the cached short strings of this thread would leak on exit
+    return NULL;
+}
+
+int CBuild_Fs_walkParallel(const char *root, uint8_t mode, int flags, int threads, CBuild_FsList *list)
+{
+    if (threads <= 0)
+    {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = count > 0 ? (int)count : 1;
+    }
+
+    CBuild_FsScan scan;
+    scan.root = root;
+    scan.rootLen = strlen(root);
+    scan.mode = mode;
+    scan.flags = flags;
+    scan.threads = threads;
+    scan.deques = (CBuild_FsDeque *)calloc(threads, sizeof(CBuild_FsDeque));
+    scan.lists = (CBuild_FsList *)calloc(threads, sizeof(CBuild_FsList));
+    atomic_init(&scan.pending, 0);
+    atomic_init(&scan.version, 0);
+    pthread_mutex_init(&scan.idleLock, NULL);
+    pthread_cond_init(&scan.idleCond, NULL);
+    scan.done = 0;
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_mutex_init(&scan.deques[i].lock, NULL);
+    }
+
+    // the root is walked here, its sub folders become the first tasks
+    CBuild_FsWalkStack folders = {NULL, 0, 0};
+    int retVal = CBuild_Fs_walkFolder(root, -1, mode, flags, &scan.lists[0], &folders);
+    if (!retVal)
+    {
+        CBuild_FsScan_pushFolders(&scan, 0, &folders);
+        scan.done = atomic_load(&scan.pending) == 0;
+
+        pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+        CBuild_FsScanWorker *workers = (CBuild_FsScanWorker *)malloc(threads * sizeof(CBuild_FsScanWorker));
+        for (int i = 0; i < threads; i++)
+        {
+            workers[i] = (CBuild_FsScanWorker){&scan, i};
+            pthread_create(&tids[i], NULL, CBuild_FsScan_worker, &workers[i]);
+        }
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_join(tids[i], NULL);
+        }
+
+        free(tids);
+        free(workers);
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        CBuild_FsList_append(list, &scan.lists[i]);
+        CBuild_FsList_deinit(&scan.lists[i]);
+        free(scan.deques[i].tasks);
+        pthread_mutex_destroy(&scan.deques[i].lock);
+    }
+    CBuild_FsList_sort(list);
+
+    free(folders.offsets);
+    free(scan.deques);
+    free(scan.lists);
+    pthread_mutex_destroy(&scan.idleLock);
+    pthread_cond_destroy(&scan.idleCond);
+    return retVal;
+}
+
+#endif
+
+CBuild_String CBuild_Fs_dir(const char *path, const char *mask, uint8_t mode, const char *delim)
+{
+    return CBuild_Fs_dirArena(NULL, path, mask, mode, delim);
+}
+
+/**
+ * @brief Lists the entries of a folder like CBuild_Fs_dir, but appends each name as a CBuild_String element
+ *        to names instead of writing one delimited string
+ *
+ * @param arena The CBuild_Arena * to keep the names in, they are then \0 terminated views into one listing
+ *              and nothing is copied, NULL to push a heap CBuild_String per name
+ * @param path The folder to list
+ * @param mask The glob the entry names must match
+ * @param mode CBUILD_FS_DIRMODE_FILES and/or CBUILD_FS_DIRMODE_FOLDERS
+ * @param names The CBuild_Vec * of CBuild_String to append to, free it with CBuild_Fs_freeNames
+ * @return int The number of names appended, -1 if the folder could not be opened
+ */
+int CBuild_Fs_dirVec(CBuild_Arena *arena, const char *path, const char *mask, uint8_t mode, CBuild_Vec *names)
+{
+    int64_t scanStart = CBuild_Trace_begin();
+    CBuild_String listing = CBuild_Fs_dirArena(arena, path, mask, mode, "/"); // '/' never appears in a name
+    CBuild_Trace_phase("scan", path, scanStart);
+    if (!listing.str)
+    {
+        return -1;
+    }
+
+    int count = 0;
+    char *ptr = listing.str;
+    char *end = listing.str + listing.len;
+    while (ptr < end)
+    {
+        char *sep = (char *)memchr(ptr, '/', end - ptr);
+        CBuild_String name;
+        if (arena)
+        {
+            *sep = '\0'; // the listing is ours, terminate the name in place
+            name = (CBuild_String){ptr, (int)(sep - ptr), 0};
+        }
+        else
+        {
+            name = CBuild_String_initView((CBuild_StrView){ptr, (int)(sep - ptr)});
+        }
+
+        CBuild_Vec_push(names, &name);
+        count++;
+        ptr = sep + 1;
+    }
+
+    CBuild_String_deinit(&listing); // no-op for the arena listing
+    return count;
+}
+
+/**
+ * @brief Frees a CBuild_Vec of CBuild_String filled by CBuild_Fs_dirVec, the arena strings are left to their arena
+ *
+ * @param names The CBuild_Vec * of CBuild_String to free
+ */
+void CBuild_Fs_freeNames(CBuild_Vec *names)
+{
+    for (int i = 0; i < names->count; i++)
+    {
+        CBuild_String_deinit(&CBUILD_VEC_AT(names, CBuild_String, i));
+    }
+
+    CBuild_Vec_deinit(names);
+}
+
+/**
+ * @brief Reads the whole file into a CBuild_String allocated from arena, a container string that is freed
+ *        with the arena, handy for the depfiles and response files read once per target
+ *
+ * @param arena The CBuild_Arena * to allocate from, NULL for a heap string like CBuild_Fs_readFile
+ * @param path The path of the file to read
+ * @return CBuild_String The contents of the file, {NULL, 0, 0} if it could not be read
+ */
+CBuild_String CBuild_Fs_readFileArena(CBuild_Arena *arena, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return (CBuild_String){NULL, 0, 0};
+    }
+
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *mem = arena ? (char *)CBuild_Arena_alloc(arena, len + 1) : (char *)malloc(len + 1);
+    if (!mem)
+    {
+        fclose(file);
+        return (CBuild_String){NULL, 0, 0};
+    }
+
+    len = fread(mem, 1, len, file);
+    mem[len] = '\0';
+    fclose(file);
+
+    return (CBuild_String){mem, (int)len, arena ? 0 : (int)len + 1};
+}
+
+/**
+ * @brief Reads the whole file into a new CBuild_String, which must be freed with CBuild_String_deinit
+ *
+ * @param path The path of the file to read
+ * @return CBuild_String The contents of the file, {NULL, 0, 0} if it could not be read
+ */
+CBuild_String CBuild_Fs_readFile(const char *path)
+{
+    return CBuild_Fs_readFileArena(NULL, path);
+}
+
+/**
+ * @brief Checks if output needs to be rebuilt from its inputs, in the same way as Make does
+ *
+ * @param output The path of the generated file, for example the object file
+ * @param inputs The array of input paths the output is generated from, for example the source file
+ * @param inputCount The number of paths in inputs
+ * @return int 1 if output is missing or older than any of the inputs (or an input is missing), 0 if it is up to date
+ */
+int CBuild_Fs_needsRebuild(const char *output, const char *const *inputs, int inputCount)
+{
+    int64_t outTime;
+    if (CBuild_Fs_mtime(output, &outTime))
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < inputCount; i++)
+    {
+        int64_t inTime;
+        if (CBuild_Fs_mtime(inputs[i], &inTime) || inTime > outTime)
+        {
+            return 1; // a missing input is left for the compiler to report
+        }
+    }
+
+    return 0;
+}
+
 #endif // INCLUDED_CBUILDER_FS
\ No newline at end of file
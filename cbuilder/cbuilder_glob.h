@@ -0,0 +1,516 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_GLOB
+#define INCLUDED_CBUILDER_GLOB
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CBUILD_GLOB_LITERAL 0        // matches chars[arg, arg + len)
+#define CBUILD_GLOB_ANY 1            // ? matches any one character except /
+#define CBUILD_GLOB_CLASS 2          // [...] matches one character of classes[arg], never /
+#define CBUILD_GLOB_STAR 3           // * matches any run of characters except /
+#define CBUILD_GLOB_GLOBSTAR 4       // ** matches any run of characters including /
+#define CBUILD_GLOB_GLOBSTAR_SLASH 5 // **/ matches nothing or any run of whole folders
+
+typedef struct
+{
+    uint8_t type; // one of CBUILD_GLOB_*
+    uint32_t arg; // offset into chars or index into classes
+    uint32_t len; // length of a literal
+} CBuild_GlobOp;
+
+typedef struct
+{
+    int opStart;       // first op of the alternative
+    int opEnd;         // one past the last op
+    int minLen;        // shortest path the alternative can match
+    uint32_t suffix;   // offset of the literal every match must end with, checked before running the ops
+    uint32_t suffixLen;
+    uint8_t exclude;   // set for the alternatives of exclude patterns
+} CBuild_GlobAlt;
+
+/*
+ * A set of include and exclude patterns compiled into flat arrays of ops, braces are expanded at compile time
+ * so *.{c,cpp} becomes the two alternatives *.c and *.cpp, matching never allocates
+ */
+typedef struct
+{
+    CBuild_GlobOp *ops;
+    int opCount;
+    int opCap;
+
+    CBuild_GlobAlt *alts;
+    int altCount;
+    int altCap;
+    int includeCount; // number of include alternatives, with none every path is included
+
+    char *chars; // pool of the literal characters
+    uint32_t charsLen;
+    uint32_t charsCap;
+
+    uint32_t (*classes)[8]; // 256 bit character sets of the [...] ops
+    int classCount;
+    int classCap;
+} CBuild_Glob;
+
+/**
+ * @brief Initialises an empty pattern set, which matches every path
+ *
+ * @param glob The CBuild_Glob * to initialise, must be freed with CBuild_Glob_deinit
+ */
+void CBuild_Glob_init(CBuild_Glob *glob)
+{
+    memset(glob, 0, sizeof(CBuild_Glob));
+}
+
+/**
+ * @brief Frees the compiled patterns
+ *
+ * @param glob The CBuild_Glob * to free
+ */
+void CBuild_Glob_deinit(CBuild_Glob *glob)
+{
+    free(glob->ops);
+    free(glob->alts);
+    free(glob->chars);
+    free(glob->classes);
+    memset(glob, 0, sizeof(CBuild_Glob));
+}
+
+CBuild_GlobOp *CBuild_Glob_pushOp(CBuild_Glob *glob, uint8_t type)
+{
+    if (glob->opCount == glob->opCap)
+    {
+        glob->opCap = glob->opCap ? glob->opCap * 2 : 32;
+        glob->ops = (CBuild_GlobOp *)realloc(glob->ops, glob->opCap * sizeof(CBuild_GlobOp));
+    }
+
+    CBuild_GlobOp *op = &glob->ops[glob->opCount++];
+    op->type = type;
+    op->arg = 0;
+    op->len = 0;
+    return op;
+}
+
+void CBuild_Glob_pushChar(CBuild_Glob *glob, char ch)
+{
+    CBuild_GlobOp *last = glob->opCount ? &glob->ops[glob->opCount - 1] : NULL;
+    if (!last || last->type != CBUILD_GLOB_LITERAL || last->arg + last->len != glob->charsLen ||
+        (glob->altCount && glob->opCount - 1 < glob->alts[glob->altCount - 1].opEnd))
+    {
+        last = NULL; // start a new literal
+    }
+
+    if (glob->charsLen == glob->charsCap)
+    {
+        glob->charsCap = glob->charsCap ? glob->charsCap * 2 : 64;
+        glob->chars = (char *)realloc(glob->chars, glob->charsCap);
+    }
+    glob->chars[glob->charsLen++] = ch;
+
+    if (last)
+    {
+        last->len++;
+    }
+    else
+    {
+        CBuild_GlobOp *op = CBuild_Glob_pushOp(glob, CBUILD_GLOB_LITERAL);
+        op->arg = glob->charsLen - 1;
+        op->len = 1;
+    }
+}
+
+// parses a [...] class starting at pattern (on the '['), returns the length consumed or 0 if it is not closed
+int CBuild_Glob_pushClass(CBuild_Glob *glob, const char *pattern)
+{
+    const char *ptr = pattern + 1;
+    int negate = *ptr == '!' || *ptr == '^';
+    if (negate)
+    {
+        ptr++;
+    }
+
+    uint32_t set[8] = {0};
+    const char *first = ptr;
+    while (*ptr && (*ptr != ']' || ptr == first))
+    {
+        unsigned char lo = *ptr, hi = *ptr;
+        if (ptr[1] == '-' && ptr[2] && ptr[2] != ']')
+        {
+            hi = ptr[2];
+            ptr += 2;
+        }
+        for (unsigned int ch = lo; ch <= hi; ch++)
+        {
+            set[ch >> 5] |= 1u << (ch & 31);
+        }
+        ptr++;
+    }
+
+    if (*ptr != ']')
+    {
+        return 0;
+    }
+
+    if (negate)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            set[i] = ~set[i];
+        }
+        set[0] &= ~1u; // never the terminator
+    }
+    set['/' >> 5] &= ~(1u << ('/' & 31));
+
+    if (glob->classCount == glob->classCap)
+    {
+        glob->classCap = glob->classCap ? glob->classCap * 2 : 8;
+        glob->classes = (uint32_t(*)[8])realloc(glob->classes, glob->classCap * sizeof(uint32_t[8]));
+    }
+    memcpy(glob->classes[glob->classCount], set, sizeof(set));
+
+    CBuild_GlobOp *op = CBuild_Glob_pushOp(glob, CBUILD_GLOB_CLASS);
+    op->arg = glob->classCount++;
+    return ptr - pattern + 1;
+}
+
+// compiles one brace free pattern into a new alternative
+void CBuild_Glob_compileAlt(CBuild_Glob *glob, const char *pattern, int exclude)
+{
+    int opStart = glob->opCount;
+    int minLen = 0;
+
+    while (*pattern)
+    {
+        if (pattern[0] == '*' && pattern[1] == '*')
+        {
+            while (*pattern == '*')
+            {
+                pattern++;
+            }
+            if (*pattern == '/')
+            {
+                CBuild_Glob_pushOp(glob, CBUILD_GLOB_GLOBSTAR_SLASH);
+                pattern++;
+            }
+            else
+            {
+                CBuild_Glob_pushOp(glob, CBUILD_GLOB_GLOBSTAR);
+            }
+            continue;
+        }
+
+        int consumed;
+        switch (*pattern)
+        {
+        case '*':
+            CBuild_Glob_pushOp(glob, CBUILD_GLOB_STAR);
+            pattern++;
+            break;
+        case '?':
+            CBuild_Glob_pushOp(glob, CBUILD_GLOB_ANY);
+            minLen++;
+            pattern++;
+            break;
+        case '[':
+            consumed = CBuild_Glob_pushClass(glob, pattern);
+            if (consumed)
+            {
+                minLen++;
+                pattern += consumed;
+                break;
+            }
+            CBuild_Glob_pushChar(glob, *pattern++); // unclosed, a plain '['
+            minLen++;
+            break;
+        case '\\':
+            if (pattern[1])
+            {
+                pattern++;
+            }
+            // fall through
+        default:
+            CBuild_Glob_pushChar(glob, *pattern++);
+            minLen++;
+            break;
+        }
+    }
+
+    if (glob->altCount == glob->altCap)
+    {
+        glob->altCap = glob->altCap ? glob->altCap * 2 : 8;
+        glob->alts = (CBuild_GlobAlt *)realloc(glob->alts, glob->altCap * sizeof(CBuild_GlobAlt));
+    }
+
+    CBuild_GlobAlt *alt = &glob->alts[glob->altCount++];
+    alt->opStart = opStart;
+    alt->opEnd = glob->opCount;
+    alt->minLen = minLen;
+    alt->suffix = 0;
+    alt->suffixLen = 0;
+    alt->exclude = exclude;
+    if (alt->opEnd > opStart && glob->ops[alt->opEnd - 1].type == CBUILD_GLOB_LITERAL)
+    {
+        alt->suffix = glob->ops[alt->opEnd - 1].arg;
+        alt->suffixLen = glob->ops[alt->opEnd - 1].len;
+    }
+
+    if (!exclude)
+    {
+        glob->includeCount++;
+    }
+}
+
+// finds the first top level '{' with a matching '}', returns 0 if the pattern has no braces
+int CBuild_Glob_findBraces(const char *pattern, const char **open, const char **close)
+{
+    for (const char *ptr = pattern; *ptr; ptr++)
+    {
+        if (*ptr == '\\' && ptr[1])
+        {
+            ptr++;
+            continue;
+        }
+        if (*ptr != '{')
+        {
+            continue;
+        }
+
+        int depth = 0;
+        for (const char *end = ptr; *end; end++)
+        {
+            if (*end == '\\' && end[1])
+            {
+                end++;
+            }
+            else if (*end == '{')
+            {
+                depth++;
+            }
+            else if (*end == '}' && --depth == 0)
+            {
+                *open = ptr;
+                *close = end;
+                return 1;
+            }
+        }
+        return 0; // unbalanced, taken literally
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compiles a pattern and adds it to the set, supported syntax: * (not crossing /), ?, [abc], [a-z], [!a-z],
+ *        ** (crossing /), ** followed by / (any number of folders, also none), {a,b,c} (nestable alternatives)
+ *        and \\ to escape the next character @n
+ *        A path matches the set if it matches any include pattern (or there are none) and no exclude pattern
+ *
+ * @param glob The CBuild_Glob * to add to
+ * @param pattern The pattern, for example *.{c,cpp,cc}
+ * @param exclude 1 to exclude the paths matching the pattern, 0 to include them
+ */
+void CBuild_Glob_add(CBuild_Glob *glob, const char *pattern, int exclude)
+{
+    const char *open, *close;
+    if (!CBuild_Glob_findBraces(pattern, &open, &close))
+    {
+        CBuild_Glob_compileAlt(glob, pattern, exclude);
+        return;
+    }
+
+    // expand every option as prefix + option + rest, the rest may hold more braces
+    size_t prefixLen = open - pattern;
+    size_t restLen = strlen(close + 1);
+    char *expanded = (char *)malloc(strlen(pattern) + 1);
+    memcpy(expanded, pattern, prefixLen);
+
+    const char *option = open + 1;
+    int depth = 0;
+    for (const char *ptr = open + 1; ptr <= close; ptr++)
+    {
+        if (*ptr == '\\' && ptr[1])
+        {
+            ptr++;
+            continue;
+        }
+        if (*ptr == '{')
+        {
+            depth++;
+        }
+        else if (*ptr == '}' && depth > 0)
+        {
+            depth--;
+        }
+        else if ((*ptr == ',' && depth == 0) || ptr == close)
+        {
+            size_t optionLen = ptr - option;
+            memcpy(expanded + prefixLen, option, optionLen);
+            memcpy(expanded + prefixLen + optionLen, close + 1, restLen + 1);
+            CBuild_Glob_add(glob, expanded, exclude);
+            option = ptr + 1;
+        }
+    }
+
+    free(expanded);
+}
+
+int CBuild_Glob_matchOps(const CBuild_Glob *glob, const CBuild_GlobOp *op, const CBuild_GlobOp *end, const char *str)
+{
+    for (; op < end; op++)
+    {
+        unsigned char ch = *str;
+        switch (op->type)
+        {
+        case CBUILD_GLOB_LITERAL:
+            if (strncmp(str, glob->chars + op->arg, op->len))
+            {
+                return 0;
+            }
+            str += op->len;
+            break;
+
+        case CBUILD_GLOB_ANY:
+            if (ch == '\0' || ch == '/')
+            {
+                return 0;
+            }
+            str++;
+            break;
+
+        case CBUILD_GLOB_CLASS:
+            if (!(glob->classes[op->arg][ch >> 5] & (1u << (ch & 31))))
+            {
+                return 0;
+            }
+            str++;
+            break;
+
+        case CBUILD_GLOB_STAR:
+            if (op + 1 == end)
+            {
+                return strchr(str, '/') == NULL;
+            }
+            while (1)
+            {
+                // only try the positions where the next literal can start
+                if ((op[1].type != CBUILD_GLOB_LITERAL || *str == glob->chars[op[1].arg]) &&
+                    CBuild_Glob_matchOps(glob, op + 1, end, str))
+                {
+                    return 1;
+                }
+                if (*str == '\0' || *str == '/')
+                {
+                    return 0;
+                }
+                str++;
+            }
+
+        case CBUILD_GLOB_GLOBSTAR:
+            if (op + 1 == end)
+            {
+                return 1;
+            }
+            while (1)
+            {
+                if (CBuild_Glob_matchOps(glob, op + 1, end, str))
+                {
+                    return 1;
+                }
+                if (*str == '\0')
+                {
+                    return 0;
+                }
+                str++;
+            }
+
+        case CBUILD_GLOB_GLOBSTAR_SLASH:
+            while (1)
+            {
+                if (CBuild_Glob_matchOps(glob, op + 1, end, str))
+                {
+                    return 1;
+                }
+                str = strchr(str, '/'); // skip one more whole folder
+                if (!str)
+                {
+                    return 0;
+                }
+                str++;
+            }
+        }
+    }
+
+    return *str == '\0';
+}
+
+int CBuild_Glob_matchAlt(const CBuild_Glob *glob, const CBuild_GlobAlt *alt, const char *path, size_t len)
+{
+    if (len < (size_t)alt->minLen ||
+        (alt->suffixLen && memcmp(path + len - alt->suffixLen, glob->chars + alt->suffix, alt->suffixLen)))
+    {
+        return 0;
+    }
+
+    return CBuild_Glob_matchOps(glob, glob->ops + alt->opStart, glob->ops + alt->opEnd, path);
+}
+
+/**
+ * @brief Matches a path against every pattern of the set in one pass, without allocating
+ *
+ * @param glob The compiled CBuild_Glob *
+ * @param path The \0 terminated path to match, / separated
+ * @return int 1 if the path is included by the set, 0 otherwise
+ */
+int CBuild_Glob_match(const CBuild_Glob *glob, const char *path)
+{
+    size_t len = strlen(path);
+    int included = glob->includeCount == 0;
+    for (int i = 0; i < glob->altCount; i++)
+    {
+        const CBuild_GlobAlt *alt = &glob->alts[i];
+        if (alt->exclude ? 0 : included) // already included, only the excludes can change that
+        {
+            continue;
+        }
+
+        if (CBuild_Glob_matchAlt(glob, alt, path, len))
+        {
+            if (alt->exclude)
+            {
+                return 0;
+            }
+            included = 1;
+        }
+    }
+
+    return included;
+}
+
+#endif // INCLUDED_CBUILDER_GLOB
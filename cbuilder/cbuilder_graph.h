@@ -0,0 +1,1120 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_GRAPH
+#define INCLUDED_CBUILDER_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_arena.h"
+#include "cbuilder_intern.h"
+#include "cbuilder_list.h"
+#include "cbuilder_exec.h"
+#include "cbuilder_fs.h"
+#include "cbuilder_db.h"
+#include "cbuilder_cache.h"
+#include "cbuilder_trace.h"
+
+// kinds of targets, set by the rule
+#define CBUILD_NODE_CUSTOM 0
+#define CBUILD_NODE_OBJECT 1
+#define CBUILD_NODE_STATIC_LIB 2
+#define CBUILD_NODE_EXECUTABLE 3
+#define CBUILD_NODE_SHARED_LIB 4
+
+// states of a node during CBuild_Graph_run
+#define CBUILD_NODE_PENDING 0  // waiting for its dependencies
+#define CBUILD_NODE_RUNNING 1  // command submitted to the pool
+#define CBUILD_NODE_BUILT 2    // command finished successfully
+#define CBUILD_NODE_UPTODATE 3 // nothing to do, or restored from the cache
+#define CBUILD_NODE_FAILED 4   // command failed
+#define CBUILD_NODE_SKIPPED 5  // a dependency failed
+
+// steps of the cache lookup of a node
+#define CBUILD_LOOKUP_NONE 0    // not looked up yet
+#define CBUILD_LOOKUP_RUNNING 1 // its preprocessor job is running
+#define CBUILD_LOOKUP_MISSED 2  // looked up without a hit, its command runs next
+
+/*
+ * A rule is a command template, every argument that is exactly one of these is replaced when a target is added:
+ *     $in      all the inputs, one argument each
+ *     $out     the output
+ *     $depfile the output with ".d" appended, the output is then checked against the headers listed in it
+ * The preprocess template, if any, lets CBuild_Cache key the outputs on the preprocessed source, in it $out
+ * is the output with ".ii" appended
+ */
+typedef struct
+{
+    const char *name;              // short name printed in the progress lines, for example "CXX"
+    const char *const *args;       // NULL terminated command template
+    const char *const *preprocess; // NULL terminated preprocessor template, NULL if the outputs are not cached
+    uint8_t kind;                  // one of CBUILD_NODE_*
+} CBuild_Rule;
+
+const char *const CBuild_cxxObjectArgs[] = {"g++", "-c", "$in", "-o", "$out", "-MMD", "-MF", "$depfile", NULL};
+const char *const CBuild_cxxPreprocessArgs[] = {"g++", "-E", "$in", "-o", "$out", NULL};
+const char *const CBuild_staticLibArgs[] = {"ar", "rcs", "$out", "$in", NULL};
+const char *const CBuild_cxxLinkArgs[] = {"g++", "$in", "-o", "$out", NULL};
+
+const CBuild_Rule CBuild_Rule_cxxObject = {"CXX", CBuild_cxxObjectArgs, CBuild_cxxPreprocessArgs, CBUILD_NODE_OBJECT};
+const CBuild_Rule CBuild_Rule_staticLib = {"AR", CBuild_staticLibArgs, NULL, CBUILD_NODE_STATIC_LIB};
+const CBuild_Rule CBuild_Rule_cxxExecutable = {"LINK", CBuild_cxxLinkArgs, NULL, CBUILD_NODE_EXECUTABLE};
+
+typedef struct
+{
+    uint32_t output;         // interned path of the output
+    const CBuild_Rule *rule; // NULL for a phony node that only groups its dependencies
+    char **argv;             // expanded command, NULL terminated, in the graph arena
+    char *depfile;           // depfile written by the command, NULL if none
+    uint32_t *inputs;        // interned input paths, in the graph arena
+    int inputCount;
+    uint64_t commandHash;     // hash of argv for CBuild_Db
+    CBuild_CacheKey cacheKey; // set when the node was looked up in the cache
+    uint8_t cacheable;        // cacheKey is valid, the outputs are stored after a successful build
+    uint8_t lookup;           // one of the CBUILD_LOOKUP_* steps of the cache lookup
+
+    uint8_t state;       // one of the CBUILD_NODE_* states
+    uint8_t blocked;     // a dependency failed or was skipped
+    int waiting;         // number of unfinished dependencies
+    int64_t estimate;    // expected duration in ns from the previous runs, -1 if never measured
+    int64_t rssEstimate; // expected peak memory in KiB from the previous runs, -1 if never measured
+    int64_t reservedKb;  // memory counted against the budget while the command runs
+    int64_t priority;    // estimated duration of the longest path from this node to the end of the build
+    CBuild_JobUsage usage; // resources used by the command in the last CBuild_Graph_run, zero if it did not run
+    int dependentStart;  // range of the nodes waiting on this one in the graph dependents array
+    int dependentCount;
+} CBuild_GraphNode;
+
+typedef struct
+{
+    CBuild_Vec nodes;      // CBuild_GraphNode, indexed by the ids returned by CBuild_Graph_add
+    CBuild_Intern paths;   // every output and input path
+    CBuild_Vec nodeOfPath; // int, node producing each interned path, -1 for source files
+    CBuild_Vec orderDeps;  // pairs of int {node, dependency} added by CBuild_Graph_addDep
+    CBuild_Arena arena;    // argv, inputs and depfile paths of all nodes
+    int *dependents;       // reverse edges of all nodes, built by CBuild_Graph_run
+
+    int64_t averageRssKb;   // expected peak memory of the targets never measured
+    int verbose;            // print every command line instead of the rule name and output
+    int64_t criticalPathNs; // estimated length of the longest path of the last CBuild_Graph_run
+    int64_t memoryBudgetKb; // commands are held back while their expected peak memory would exceed it, 0 for no limit
+    int64_t runningKb;      // expected peak memory of the running commands
+    int built;   // number of commands run successfully by the last CBuild_Graph_run
+    int upToDate;
+    int failed;
+    int skipped;
+} CBuild_Graph;
+
+/**
+ * @brief Initialises an empty build graph, targets are added with CBuild_Graph_add and built with CBuild_Graph_run
+ *
+ * @param graph The CBuild_Graph * to initialise, must be freed with CBuild_Graph_deinit
+ */
+void CBuild_Graph_init(CBuild_Graph *graph)
+{
+    CBuild_Vec_init(&graph->nodes, sizeof(CBuild_GraphNode));
+    CBuild_Intern_init(&graph->paths);
+    CBuild_Vec_init(&graph->nodeOfPath, sizeof(int));
+    CBuild_Vec_init(&graph->orderDeps, 2 * sizeof(int));
+    CBuild_Arena_init(&graph->arena, 0);
+    graph->dependents = NULL;
+
+    graph->verbose = 0;
+    graph->criticalPathNs = 0;
+    graph->memoryBudgetKb = 0;
+    graph->averageRssKb = 0;
+    graph->runningKb = 0;
+    graph->built = 0;
+    graph->upToDate = 0;
+    graph->failed = 0;
+    graph->skipped = 0;
+}
+
+/**
+ * @brief Frees the graph and all the paths and commands of its nodes
+ *
+ * @param graph The CBuild_Graph * to free
+ */
+void CBuild_Graph_deinit(CBuild_Graph *graph)
+{
+    CBuild_Vec_deinit(&graph->nodes);
+    CBuild_Intern_deinit(&graph->paths);
+    CBuild_Vec_deinit(&graph->nodeOfPath);
+    CBuild_Vec_deinit(&graph->orderDeps);
+    CBuild_Arena_deinit(&graph->arena);
+    free(graph->dependents);
+    graph->dependents = NULL;
+}
+
+// interns a path and keeps nodeOfPath as long as the pool
+uint32_t CBuild_Graph_path(CBuild_Graph *graph, const char *path)
+{
+    uint32_t id = CBuild_Intern_add(&graph->paths, path);
+    while (graph->nodeOfPath.count < (int)graph->paths.count)
+    {
+        int none = -1;
+        CBuild_Vec_push(&graph->nodeOfPath, &none);
+    }
+
+    return id;
+}
+
+// copies a string into the graph arena
+char *CBuild_Graph_joinArena(CBuild_Graph *graph, const char *str, const char *suffix)
+{
+    size_t len = strlen(str), suffixLen = strlen(suffix);
+    char *mem = (char *)CBuild_Arena_alloc(&graph->arena, len + suffixLen + 1);
+    memcpy(mem, str, len);
+    memcpy(mem + len, suffix, suffixLen + 1);
+    return mem;
+}
+
+// expands a rule template for a node, see CBuild_Rule
+char **CBuild_Graph_expand(CBuild_Graph *graph, const char *const *args, CBuild_GraphNode *node, const char *out)
+{
+    int count = 1;
+    for (int i = 0; args[i] != NULL; i++)
+    {
+        count += args[i][0] == '$' && strcmp(args[i], "$in") == 0 ? node->inputCount : 1;
+    }
+
+    char **argv = (char **)CBuild_Arena_alloc(&graph->arena, count * sizeof(char *));
+    int argc = 0;
+    for (int i = 0; args[i] != NULL; i++)
+    {
+        if (args[i][0] != '$') // most of a template are the fixed flags
+        {
+            argv[argc++] = (char *)args[i];
+        }
+        else if (strcmp(args[i], "$in") == 0)
+        {
+            for (int j = 0; j < node->inputCount; j++)
+            {
+                argv[argc++] = (char *)CBuild_Intern_str(&graph->paths, node->inputs[j]);
+            }
+        }
+        else if (strcmp(args[i], "$out") == 0)
+        {
+            argv[argc++] = (char *)out;
+        }
+        else if (strcmp(args[i], "$depfile") == 0)
+        {
+            if (!node->depfile)
+            {
+                node->depfile = CBuild_Graph_joinArena(graph, out, ".d");
+            }
+            argv[argc++] = node->depfile;
+        }
+        else
+        {
+            argv[argc++] = (char *)args[i];
+        }
+    }
+    argv[argc] = NULL;
+
+    return argv;
+}
+
+/**
+ * @brief Adds a target built by rule from inputs, inputs that are the output of another target make this target
+ *        wait for that one, any other input is a source file @n
+ *        Note: targets may be added in any order, the edges are resolved by CBuild_Graph_run
+ *
+ * @param graph The CBuild_Graph * to add to
+ * @param rule The CBuild_Rule * to build with, NULL for a phony target that only groups its inputs
+ * @param output The path of the output, must be unique in the graph
+ * @param inputs The array of input paths, copied into the graph
+ * @param inputCount The number of paths in inputs
+ * @return int The id of the new node, -1 if output already has a node
+ */
+int CBuild_Graph_add(CBuild_Graph *graph, const CBuild_Rule *rule, const char *output, const char *const *inputs, int inputCount)
+{
+    uint32_t outputId = CBuild_Graph_path(graph, output);
+    if (CBUILD_VEC_AT(&graph->nodeOfPath, int, outputId) >= 0)
+    {
+        fprintf(stderr, "[CBuilder Graph Error] %s is the output of more than one target\n", output);
+        return -1;
+    }
+
+    CBuild_GraphNode node;
+    memset(&node, 0, sizeof(CBuild_GraphNode));
+    node.output = outputId;
+    node.rule = rule;
+    node.estimate = -1;
+    node.rssEstimate = -1;
+    node.inputCount = inputCount;
+    node.inputs = (uint32_t *)CBuild_Arena_alloc(&graph->arena, (inputCount ? inputCount : 1) * sizeof(uint32_t));
+    for (int i = 0; i < inputCount; i++)
+    {
+        node.inputs[i] = CBuild_Graph_path(graph, inputs[i]);
+    }
+
+    const char *out = CBuild_Intern_str(&graph->paths, outputId);
+    if (rule)
+    {
+        node.argv = CBuild_Graph_expand(graph, rule->args, &node, out);
+        node.commandHash = CBuild_Db_hashArgv(node.argv);
+    }
+
+    int id = graph->nodes.count;
+    CBuild_Vec_push(&graph->nodes, &node);
+    CBUILD_VEC_AT(&graph->nodeOfPath, int, outputId) = id;
+    return id;
+}
+
+/**
+ * @brief Makes node wait for dep even though none of its inputs is the output of dep, for example for
+ *        generated headers that are only found through the depfile
+ *
+ * @param graph The CBuild_Graph * holding both nodes
+ * @param node The id of the waiting node
+ * @param dep The id of the node to wait for
+ */
+void CBuild_Graph_addDep(CBuild_Graph *graph, int node, int dep)
+{
+    int pair[2] = {node, dep};
+    CBuild_Vec_push(&graph->orderDeps, pair);
+}
+
+/**
+ * @brief Finds the node building output
+ *
+ * @param graph The CBuild_Graph * to search
+ * @param output The path of the output
+ * @return int The id of the node, -1 if no target builds output
+ */
+int CBuild_Graph_find(CBuild_Graph *graph, const char *output)
+{
+    uint32_t id = CBuild_Intern_find(&graph->paths, CBuild_StrView_fromCStr(output));
+    return id == CBUILD_INTERN_NONE ? -1 : CBUILD_VEC_AT(&graph->nodeOfPath, int, id);
+}
+
+/**
+ * @brief Returns the output path of a node, valid until CBuild_Graph_deinit
+ *
+ * @param graph The CBuild_Graph * holding the node
+ * @param node The id of the node
+ * @return const char* The output path
+ */
+const char *CBuild_Graph_output(CBuild_Graph *graph, int node)
+{
+    return CBuild_Intern_str(&graph->paths, CBUILD_VEC_AT(&graph->nodes, CBuild_GraphNode, node).output);
+}
+
+// the node producing the input of another node, -1 for source files
+int CBuild_Graph_producer(CBuild_Graph *graph, uint32_t path)
+{
+    return CBUILD_VEC_AT(&graph->nodeOfPath, int, path);
+}
+
+// calls fn(graph, from, to, arg) for every edge, from must finish before to starts
+void CBuild_Graph_forEachEdge(CBuild_Graph *graph, void (*fn)(CBuild_Graph *, int, int, void *), void *arg)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    for (int i = 0; i < graph->nodes.count; i++)
+    {
+        for (int j = 0; j < nodes[i].inputCount; j++)
+        {
+            int producer = CBuild_Graph_producer(graph, nodes[i].inputs[j]);
+            if (producer >= 0 && producer != i)
+            {
+                fn(graph, producer, i, arg);
+            }
+        }
+    }
+
+    for (int i = 0; i < graph->orderDeps.count; i++)
+    {
+        int *pair = (int *)CBuild_Vec_at(&graph->orderDeps, i);
+        fn(graph, pair[1], pair[0], arg);
+    }
+}
+
+void CBuild_Graph_countEdge(CBuild_Graph *graph, int from, int to, void *arg)
+{
+    (void)arg;
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    nodes[from].dependentCount++;
+    nodes[to].waiting++;
+}
+
+void CBuild_Graph_storeEdge(CBuild_Graph *graph, int from, int to, void *arg)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    int *fill = (int *)arg; // dependents already stored per node
+    graph->dependents[nodes[from].dependentStart + fill[from]++] = to;
+}
+
+// builds the reverse edges and the number of dependencies of every node
+void CBuild_Graph_link(CBuild_Graph *graph)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    int count = graph->nodes.count;
+    for (int i = 0; i < count; i++)
+    {
+        nodes[i].state = CBUILD_NODE_PENDING;
+        nodes[i].blocked = 0;
+        nodes[i].lookup = CBUILD_LOOKUP_NONE;
+        nodes[i].waiting = 0;
+        nodes[i].dependentCount = 0;
+    }
+
+    CBuild_Graph_forEachEdge(graph, CBuild_Graph_countEdge, NULL);
+
+    int total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        nodes[i].dependentStart = total;
+        total += nodes[i].dependentCount;
+    }
+
+    free(graph->dependents);
+    graph->dependents = (int *)malloc((total ? total : 1) * sizeof(int));
+    int *fill = (int *)calloc(count ? count : 1, sizeof(int));
+    CBuild_Graph_forEachEdge(graph, CBuild_Graph_storeEdge, fill);
+    free(fill);
+}
+
+// expected duration of a node, unmeasured commands are assumed to take as long as the average measured one
+int64_t CBuild_Graph_estimate(CBuild_GraphNode *node, int64_t average)
+{
+    if (!node->rule)
+    {
+        return 0;
+    }
+
+    return node->estimate >= 0 ? node->estimate : average;
+}
+
+// sets the priority of every node to the estimated length of the longest path from it to the end of the build,
+// must be called after CBuild_Graph_link, returns the critical path length
+int64_t CBuild_Graph_prioritize(CBuild_Graph *graph)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    int count = graph->nodes.count;
+
+    int64_t total = 0;
+    int measured = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (nodes[i].rule && nodes[i].estimate >= 0)
+        {
+            total += nodes[i].estimate;
+            measured++;
+        }
+    }
+    int64_t average = measured ? total / measured : 1000000000; // a second when nothing is known yet
+
+    // topological order by Kahn, then the priorities are summed from the sinks backwards
+    int *order = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    int *waiting = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    int orderCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        waiting[i] = nodes[i].waiting;
+        if (waiting[i] == 0)
+        {
+            order[orderCount++] = i;
+        }
+    }
+    for (int head = 0; head < orderCount; head++)
+    {
+        CBuild_GraphNode *node = &nodes[order[head]];
+        for (int i = 0; i < node->dependentCount; i++)
+        {
+            int dependent = graph->dependents[node->dependentStart + i];
+            if (--waiting[dependent] == 0)
+            {
+                order[orderCount++] = dependent;
+            }
+        }
+    }
+
+    int64_t critical = 0;
+    for (int i = 0; i < count; i++) // nodes on a cycle keep their own estimate, the run reports the cycle
+    {
+        nodes[i].priority = CBuild_Graph_estimate(&nodes[i], average);
+    }
+    for (int head = orderCount - 1; head >= 0; head--)
+    {
+        CBuild_GraphNode *node = &nodes[order[head]];
+        int64_t longest = 0;
+        for (int i = 0; i < node->dependentCount; i++)
+        {
+            int64_t priority = nodes[graph->dependents[node->dependentStart + i]].priority;
+            longest = priority > longest ? priority : longest;
+        }
+
+        node->priority += longest;
+        critical = node->priority > critical ? node->priority : critical;
+    }
+
+    free(order);
+    free(waiting);
+    return critical;
+}
+
+// 1 if node a should be started before node b, the longer remaining path first, then in the order of declaration
+int CBuild_Graph_before(CBuild_GraphNode *nodes, int a, int b)
+{
+    return nodes[a].priority != nodes[b].priority ? nodes[a].priority > nodes[b].priority : a < b;
+}
+
+// adds a node to the binary heap of ready nodes
+void CBuild_Graph_readyPush(CBuild_Graph *graph, int *heap, int *heapCount, int index)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    int i = (*heapCount)++;
+    while (i > 0 && CBuild_Graph_before(nodes, index, heap[(i - 1) / 2]))
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = index;
+}
+
+// removes the ready node with the longest remaining path
+int CBuild_Graph_readyPop(CBuild_Graph *graph, int *heap, int *heapCount)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    int top = heap[0];
+    int last = heap[--(*heapCount)];
+
+    int i = 0;
+    while (2 * i + 1 < *heapCount)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < *heapCount && CBuild_Graph_before(nodes, heap[child + 1], heap[child]))
+        {
+            child++;
+        }
+        if (!CBuild_Graph_before(nodes, heap[child], last))
+        {
+            break;
+        }
+
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+
+    return top;
+}
+
+/**
+ * @brief Loads the durations of the targets measured by previous runs, CBuild_Graph_run then starts the targets
+ *        with the longest remaining path to the end of the build first, instead of in the order they were added,
+ *        so a few slow translation units do not end up as a serial tail @n
+ *        The peak memory of the targets is loaded too, for the memory budget of CBuild_Graph_run @n
+ *        The file is a text file with a line "<nanoseconds> <KiB> <output path>" per target, missing files are ignored
+ *
+ * @param graph The CBuild_Graph * with all the targets added
+ * @param path The path of the duration log, for example ./build/.cbuild_durations
+ * @return int The number of targets with a known duration
+ */
+int CBuild_Graph_loadDurations(CBuild_Graph *graph, const char *path)
+{
+    CBuild_String data = CBuild_Fs_readFileArena(&graph->arena, path);
+    if (!data.str)
+    {
+        return 0;
+    }
+
+    int known = 0;
+    char *ptr = data.str;
+    char *end = data.str + data.len;
+    while (ptr < end)
+    {
+        char *lineEnd = (char *)memchr(ptr, '\n', end - ptr);
+        if (!lineEnd)
+        {
+            break; // partial line from an interrupted write
+        }
+        *lineEnd = '\0';
+
+        char *rssStr, *name;
+        long long duration = strtoll(ptr, &rssStr, 10);
+        long long rssKb = strtoll(rssStr, &name, 10);
+        if (rssStr != ptr && name != rssStr && *name == ' ')
+        {
+            int node = CBuild_Graph_find(graph, name + 1);
+            if (node >= 0 && duration >= 0)
+            {
+                CBuild_GraphNode *target = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, node);
+                target->estimate = duration;
+                target->rssEstimate = rssKb;
+                known++;
+            }
+        }
+
+        ptr = lineEnd + 1;
+    }
+
+    return known;
+}
+
+/**
+ * @brief Writes the duration and peak memory of every target for the next CBuild_Graph_loadDurations, targets
+ *        that did not run keep their loaded values
+ *
+ * @param graph The CBuild_Graph * after CBuild_Graph_run
+ * @param path The path of the duration log
+ * @return int 0 on success, -1 if the file could not be written
+ */
+int CBuild_Graph_saveDurations(CBuild_Graph *graph, const char *path)
+{
+    size_t pathLen = strlen(path);
+    char tmpPath[pathLen + 5];
+    memcpy(tmpPath, path, pathLen);
+    memcpy(tmpPath + pathLen, ".tmp", 5);
+
+    FILE *file = fopen(tmpPath, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "[CBuilder Graph Error] Failed to open %s for writing\n", tmpPath);
+        return -1;
+    }
+
+    for (int i = 0; i < graph->nodes.count; i++)
+    {
+        CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, i);
+        if (node->rule && node->estimate >= 0)
+        {
+            fprintf(file, "%lld %lld %s\n", (long long)node->estimate, (long long)node->rssEstimate,
+                    CBuild_Graph_output(graph, i));
+        }
+    }
+
+    int failed = fclose(file) != 0;
+    if (failed || CBuild_Fs_replace(tmpPath, path)) // replaced at once, a crash never leaves half a log
+    {
+        remove(tmpPath);
+        return -1;
+    }
+
+    return 0;
+}
+
+typedef struct
+{
+    int64_t key;
+    int index;
+} CBuild_GraphRank;
+
+// qsort comparator ordering CBuild_GraphRank by descending key
+int CBuild_Graph_rankCompare(const void *a, const void *b)
+{
+    int64_t keyA = ((const CBuild_GraphRank *)a)->key;
+    int64_t keyB = ((const CBuild_GraphRank *)b)->key;
+    return keyA < keyB ? 1 : keyA > keyB ? -1 : 0;
+}
+
+// prints the topN targets of ranks after sorting them
+void CBuild_Graph_printRanks(CBuild_Graph *graph, CBuild_GraphRank *ranks, int count, int topN, const char *title)
+{
+    qsort(ranks, count, sizeof(CBuild_GraphRank), CBuild_Graph_rankCompare);
+    printf("[CBuilder Graph] %s:\n", title);
+    for (int i = 0; i < count && i < topN; i++)
+    {
+        CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, ranks[i].index);
+        printf("    %8.2f s wall %8.2f s user %8.2f s sys %9.1f MiB  %s\n", node->usage.wallNs / 1e9,
+               node->usage.userNs / 1e9, node->usage.sysNs / 1e9, node->usage.maxRssKb / 1024.0,
+               CBuild_Graph_output(graph, ranks[i].index));
+    }
+}
+
+/**
+ * @brief Prints the resources used by the commands of the last CBuild_Graph_run, the topN slowest and the
+ *        topN largest targets, to find the translation units to split or to run with fewer neighbours @n
+ *        Note: the CPU times and the peak memory are only measured on posix systems
+ *
+ * @param graph The CBuild_Graph * after CBuild_Graph_run
+ * @param topN The number of targets in each list
+ */
+void CBuild_Graph_printUsage(CBuild_Graph *graph, int topN)
+{
+    CBuild_GraphRank *byTime = (CBuild_GraphRank *)malloc((graph->nodes.count + 1) * sizeof(CBuild_GraphRank));
+    CBuild_GraphRank *bySize = (CBuild_GraphRank *)malloc((graph->nodes.count + 1) * sizeof(CBuild_GraphRank));
+    int count = 0;
+    int64_t cpuNs = 0, maxRssKb = 0;
+    for (int i = 0; i < graph->nodes.count; i++)
+    {
+        CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, i);
+        if (node->usage.wallNs > 0)
+        {
+            byTime[count] = (CBuild_GraphRank){node->usage.wallNs, i};
+            bySize[count] = (CBuild_GraphRank){node->usage.maxRssKb, i};
+            count++;
+            cpuNs += node->usage.userNs + node->usage.sysNs;
+            maxRssKb = node->usage.maxRssKb > maxRssKb ? node->usage.maxRssKb : maxRssKb;
+        }
+    }
+
+    if (count > 0)
+    {
+        printf("[CBuilder Graph] %d commands, %.2f s CPU, largest %.1f MiB\n", count, cpuNs / 1e9, maxRssKb / 1024.0);
+        CBuild_Graph_printRanks(graph, byTime, count, topN, "Slowest targets");
+        CBuild_Graph_printRanks(graph, bySize, count, topN, "Largest targets");
+    }
+
+    free(byTime);
+    free(bySize);
+}
+
+// sets the expected peak memory of the targets never measured to the average of the measured ones
+void CBuild_Graph_averageRss(CBuild_Graph *graph)
+{
+    int64_t total = 0;
+    int measured = 0;
+    for (int i = 0; i < graph->nodes.count; i++)
+    {
+        CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, i);
+        node->usage = (CBuild_JobUsage){0, 0, 0, 0};
+        if (node->rule && node->rssEstimate >= 0)
+        {
+            total += node->rssEstimate;
+            measured++;
+        }
+    }
+
+    graph->averageRssKb = measured ? total / measured : 0;
+    graph->runningKb = 0;
+}
+
+// expected peak memory of the command of a node
+int64_t CBuild_Graph_memory(CBuild_Graph *graph, CBuild_GraphNode *node)
+{
+    return node->rssEstimate >= 0 ? node->rssEstimate : graph->averageRssKb;
+}
+
+// checks the node against the database, or the mtimes of its inputs without one
+int CBuild_Graph_needsRebuild(CBuild_Graph *graph, CBuild_GraphNode *node, CBuild_Db *db)
+{
+    const char *out = CBuild_Intern_str(&graph->paths, node->output);
+    if (db)
+    {
+        return CBuild_Db_needsRebuild(db, out, node->commandHash);
+    }
+
+    const char *inputs[node->inputCount ? node->inputCount : 1];
+    for (int i = 0; i < node->inputCount; i++)
+    {
+        inputs[i] = CBuild_Intern_str(&graph->paths, node->inputs[i]);
+    }
+    return CBuild_Fs_needsRebuild(out, inputs, node->inputCount);
+}
+
+// records a freshly built node in the database and the cache
+void CBuild_Graph_record(CBuild_Graph *graph, CBuild_GraphNode *node, CBuild_Db *db, CBuild_Cache *cache)
+{
+    const char *out = CBuild_Intern_str(&graph->paths, node->output);
+    int64_t depfileTime;
+    if (db)
+    {
+        if (node->depfile && CBuild_Fs_mtime(node->depfile, &depfileTime) == 0) // plain assembly writes none
+        {
+            CBuild_Db_recordDepfile(db, out, node->commandHash, node->depfile);
+        }
+        else
+        {
+            const char *inputs[node->inputCount ? node->inputCount : 1];
+            for (int i = 0; i < node->inputCount; i++)
+            {
+                inputs[i] = CBuild_Intern_str(&graph->paths, node->inputs[i]);
+            }
+            CBuild_Db_record(db, out, node->commandHash, inputs, node->inputCount);
+        }
+    }
+
+    if (cache && node->cacheable)
+    {
+        const char *outputs[] = {out, node->depfile};
+        CBuild_Cache_store(cache, node->cacheKey, outputs, node->depfile ? 2 : 1);
+    }
+}
+
+// finishes the cache lookup of a node once its preprocessor job id exited, 1 if its outputs were restored
+int CBuild_Graph_lookup(CBuild_Graph *graph, CBuild_GraphNode *node, CBuild_JobPool *pool, int id, CBuild_Db *db,
+                        CBuild_Cache *cache, int *started)
+{
+    const char *out = CBuild_Intern_str(&graph->paths, node->output);
+    CBuild_String ppOutput = CBuild_String_joinViews((CBuild_StrView[]){CBuild_StrView_fromCStr(out), CBUILD_VIEW(".ii")}, 2);
+    node->lookup = CBUILD_LOOKUP_MISSED;
+
+    int64_t fetchStart = CBuild_Trace_begin();
+    node->cacheKey = CBuild_Cache_keyInit(node->commandHash);
+    int hashed = CBuild_JobPool_status(pool, id) == 0 && CBuild_Cache_keyAddFile(&node->cacheKey, ppOutput.str) == 0;
+    remove(ppOutput.str);
+    CBuild_String_deinit(&ppOutput);
+    if (!hashed)
+    {
+        CBuild_Trace_phase("cache fetch", out, fetchStart);
+        return 0; // the compile reports the error
+    }
+
+    node->cacheable = 1;
+    const char *outputs[] = {out, node->depfile};
+    int hit = CBuild_Cache_fetch(cache, node->cacheKey, outputs, node->depfile ? 2 : 1);
+    CBuild_Trace_phase(hit ? "cache hit" : "cache miss", out, fetchStart);
+    if (!hit)
+    {
+        return 0;
+    }
+
+    printf("[%d] CACHED %s\n", ++*started, out);
+    if (db) // the restored outputs are as good as built ones
+    {
+        node->cacheable = 0;
+        CBuild_Graph_record(graph, node, db, NULL);
+    }
+    node->state = CBUILD_NODE_UPTODATE;
+    graph->upToDate++;
+    return 1;
+}
+
+// marks a node finished and moves the dependents whose dependencies are all finished to the ready heap
+void CBuild_Graph_release(CBuild_Graph *graph, int index, int *ready, int *readyCount)
+{
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+    CBuild_GraphNode *node = &nodes[index];
+    int ok = node->state == CBUILD_NODE_BUILT || node->state == CBUILD_NODE_UPTODATE;
+
+    for (int i = 0; i < node->dependentCount; i++)
+    {
+        CBuild_GraphNode *dependent = &nodes[graph->dependents[node->dependentStart + i]];
+        dependent->blocked |= !ok;
+        if (--dependent->waiting == 0)
+        {
+            CBuild_Graph_readyPush(graph, ready, readyCount, graph->dependents[node->dependentStart + i]);
+        }
+    }
+}
+
+// sets the final state of a node whose command finished as job id of pool
+void CBuild_Graph_finish(CBuild_Graph *graph, CBuild_GraphNode *node, CBuild_JobPool *pool, int id, CBuild_Db *db,
+                         CBuild_Cache *cache)
+{
+    int status = CBuild_JobPool_status(pool, id);
+    node->usage = *CBuild_JobPool_usage(pool, id);
+    graph->runningKb -= node->reservedKb;
+    node->reservedKb = 0;
+
+    node->estimate = node->usage.wallNs; // the next run schedules with them
+    if (node->usage.maxRssKb > 0)
+    {
+        node->rssEstimate = node->usage.maxRssKb;
+    }
+
+    if (status == 0)
+    {
+        node->state = CBUILD_NODE_BUILT;
+        graph->built++;
+        CBuild_Graph_record(graph, node, db, cache);
+    }
+    else
+    {
+        node->state = CBUILD_NODE_FAILED;
+        graph->failed++;
+    }
+}
+
+// submits the command of a node, returns 1 if it is running in the pool, 0 if it already has its final state
+int CBuild_Graph_submit(CBuild_Graph *graph, int index, CBuild_JobPool *pool, CBuild_Db *db, CBuild_Cache *cache,
+                        CBuild_HashMap *jobs, int *started)
+{
+    CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, index);
+    const char *out = CBuild_Intern_str(&graph->paths, node->output);
+
+    // the command writes new files, so ar, which only adds members, never keeps stale objects
+    remove(out);
+    if (node->depfile)
+    {
+        remove(node->depfile);
+    }
+
+    if (graph->verbose)
+    {
+        CBuild_String command = CBuild_String_commandArgv(node->argv, CBUILD_CMD_QUOTE); // one allocation
+        printf("[%d] %s\n", ++*started, command.str);
+        CBuild_String_deinit(&command);
+    }
+    else
+    {
+        printf("[%d] %s %s\n", ++*started, node->rule->name, out);
+    }
+
+    CBuild_String errorMsg = CBuild_String_joinViews(
+        (CBuild_StrView[]){CBUILD_VIEW("[CBuilder Graph] Failed to build "), CBuild_StrView_fromCStr(out), CBUILD_VIEW("\n")}, 3);
+    pool->label = out; // the job is named after its output in the trace
+    int id = CBuild_JobPool_submitArgv(pool, node->argv, "", errorMsg.str);
+    pool->label = NULL;
+    CBuild_String_deinit(&errorMsg);
+
+    if (id < 0)
+    {
+        node->state = CBUILD_NODE_FAILED;
+        graph->failed++;
+        return 0;
+    }
+
+    node->reservedKb = CBuild_Graph_memory(graph, node);
+    graph->runningKb += node->reservedKb;
+    if (CBuild_JobPool_status(pool, id) >= 0) // pools without background jobs finish in submit
+    {
+        CBuild_Graph_finish(graph, node, pool, id, db, cache);
+        return 0;
+    }
+
+    node->state = CBUILD_NODE_RUNNING;
+    CBuild_HashMap_put(jobs, &id, &index);
+    return 1;
+}
+
+// starts a ready node, returns 1 if its preprocessor or its command is running in the pool, 0 if it already
+// has its final state
+int CBuild_Graph_start(CBuild_Graph *graph, int index, CBuild_JobPool *pool, CBuild_Db *db, CBuild_Cache *cache,
+                       CBuild_HashMap *jobs, int *started)
+{
+    CBuild_GraphNode *node = (CBuild_GraphNode *)CBuild_Vec_at(&graph->nodes, index);
+    const char *out = CBuild_Intern_str(&graph->paths, node->output);
+
+    if (node->lookup == CBUILD_LOOKUP_MISSED) // back in the ready queue after its preprocessor job
+    {
+        return CBuild_Graph_submit(graph, index, pool, db, cache, jobs, started);
+    }
+
+    if (node->blocked)
+    {
+        node->state = CBUILD_NODE_SKIPPED;
+        graph->skipped++;
+        return 0;
+    }
+
+    int64_t checkStart = CBuild_Trace_begin();
+    int rebuild = node->rule && CBuild_Graph_needsRebuild(graph, node, db);
+    CBuild_Trace_phase("dep check", out, checkStart);
+    if (!rebuild)
+    {
+        node->state = CBUILD_NODE_UPTODATE;
+        graph->upToDate++;
+        return 0;
+    }
+
+    // the output folder may not exist yet in a fresh build tree
+    const char *slash = strrchr(out, '/');
+    if (slash && slash != out)
+    {
+        int len = slash - out;
+        char folder[len + 1];
+        memcpy(folder, out, len);
+        folder[len] = '\0';
+        CBuild_Fs_mkdir(folder);
+    }
+
+    // the preprocessor runs as a job of its own, so lookups run in parallel like compiles, and the lookup
+    // and the command continue it once it exits, it is quiet as a failing preprocessor only makes a miss and
+    // the command then prints the same diagnostics
+    if (cache && node->rule->preprocess)
+    {
+        char *ppOutput = CBuild_Graph_joinArena(graph, out, ".ii");
+        char **ppArgv = CBuild_Graph_expand(graph, node->rule->preprocess, node, ppOutput);
+        pool->label = ppOutput;
+        pool->quiet = 1;
+        int id = CBuild_JobPool_submitArgv(pool, ppArgv, "", "");
+        pool->label = NULL;
+        pool->quiet = 0;
+
+        if (id >= 0 && CBuild_JobPool_status(pool, id) < 0)
+        {
+            node->lookup = CBUILD_LOOKUP_RUNNING;
+            node->state = CBUILD_NODE_RUNNING;
+            CBuild_HashMap_put(jobs, &id, &index);
+            return 1;
+        }
+        if (id >= 0 && CBuild_Graph_lookup(graph, node, pool, id, db, cache, started))
+        {
+            return 0;
+        }
+    }
+
+    return CBuild_Graph_submit(graph, index, pool, db, cache, jobs, started);
+}
+
+/**
+ * @brief Builds every target of the graph in dependency order, a target starts as soon as all the targets it
+ *        depends on are finished, so independent targets run in parallel upto the job limit of pool and a link
+ *        only waits for its own objects @n
+ *        Of the ready targets the one with the longest remaining path is started first, with the durations
+ *        from CBuild_Graph_loadDurations @n
+ *        With graph->memoryBudgetKb set, a target is also held back while the peak memory measured by earlier
+ *        runs of the running commands and its own would exceed the budget @n
+ *        Targets whose output is up to date (by db if given, else by the input mtimes) are not run, and targets
+ *        depending on a failed one are skipped @n
+ *        Each target that runs its command or is restored from the cache is printed with its running number, no
+ *        total is shown as whether a target is up to date is only known once its dependencies are finished
+ *
+ * @param graph The CBuild_Graph * to build
+ * @param pool The CBuild_JobPool * to run the commands in
+ * @param db The CBuild_Db * to check and record the outputs in, may be NULL
+ * @param cache The CBuild_Cache * to restore and store the outputs of rules with a preprocess template, may be NULL
+ * @return int The number of failed targets, -1 if the graph has a cycle, -2 if the pool failed to wait for the
+ *         running commands
+ */
+int CBuild_Graph_run(CBuild_Graph *graph, CBuild_JobPool *pool, CBuild_Db *db, CBuild_Cache *cache)
+{
+    int count = graph->nodes.count;
+    graph->built = 0;
+    graph->upToDate = 0;
+    graph->failed = 0;
+    graph->skipped = 0;
+
+    int64_t linkStart = CBuild_Trace_begin();
+    CBuild_Graph_link(graph);
+    CBuild_Trace_phase("link graph", NULL, linkStart);
+
+    int64_t prioritizeStart = CBuild_Trace_begin();
+    graph->criticalPathNs = CBuild_Graph_prioritize(graph);
+    CBuild_Graph_averageRss(graph);
+    CBuild_Trace_phase("schedule", NULL, prioritizeStart);
+    CBuild_GraphNode *nodes = (CBuild_GraphNode *)graph->nodes.data;
+
+    // heap, a node is queued again after a cache miss but is never in it twice at once
+    int *ready = (int *)malloc((count ? count : 1) * sizeof(int));
+    int readyCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (nodes[i].waiting == 0)
+        {
+            CBuild_Graph_readyPush(graph, ready, &readyCount, i);
+        }
+    }
+
+    CBuild_HashMap jobs; // job id to node id
+    CBuild_HashMap_init(&jobs, sizeof(int), sizeof(int), NULL, NULL);
+
+    int finished = 0, started = 0, running = 0, poolFailed = 0;
+    while (finished < count)
+    {
+        while (readyCount > 0 && CBuild_JobPool_canStart(pool))
+        {
+            // over the memory budget the next target waits for a running one, alone it always starts
+            CBuild_GraphNode *next = &nodes[ready[0]];
+            if (running > 0 && graph->memoryBudgetKb > 0 && next->rule && !next->blocked &&
+                graph->runningKb + CBuild_Graph_memory(graph, next) > graph->memoryBudgetKb)
+            {
+                break;
+            }
+
+            int index = CBuild_Graph_readyPop(graph, ready, &readyCount);
+            if (CBuild_Graph_start(graph, index, pool, db, cache, &jobs, &started))
+            {
+                running++;
+                continue;
+            }
+
+            finished++;
+            CBuild_Graph_release(graph, index, ready, &readyCount);
+        }
+
+        if (running == 0)
+        {
+            if (readyCount == 0)
+            {
+                break; // nothing running and nothing ready, the rest waits on a cycle
+            }
+            continue;
+        }
+
+        CBuild_JobResult result;
+        int id = CBuild_JobPool_waitAny(pool, &result);
+        if (id == CBUILD_JOB_TOKEN) // a jobserver token for the next ready target
+        {
+            continue;
+        }
+        if (id < 0) // the pool printed why
+        {
+            poolFailed = 1;
+            break;
+        }
+
+        int *index = (int *)CBuild_HashMap_get(&jobs, &result.id);
+        if (!index) // a job submitted to the pool outside of the graph
+        {
+            continue;
+        }
+
+        int nodeIndex = *index;
+        CBuild_HashMap_remove(&jobs, &result.id);
+        running--;
+        if (nodes[nodeIndex].lookup == CBUILD_LOOKUP_RUNNING)
+        {
+            // on a miss the command waits for a free job like any other ready target
+            if (!CBuild_Graph_lookup(graph, &nodes[nodeIndex], pool, result.id, db, cache, &started))
+            {
+                nodes[nodeIndex].state = CBUILD_NODE_PENDING;
+                CBuild_Graph_readyPush(graph, ready, &readyCount, nodeIndex);
+                continue;
+            }
+        }
+        else
+        {
+            CBuild_Graph_finish(graph, &nodes[nodeIndex], pool, result.id, db, cache);
+        }
+
+        finished++;
+        CBuild_Graph_release(graph, nodeIndex, ready, &readyCount);
+    }
+
+    CBuild_HashMap_deinit(&jobs);
+    free(ready);
+
+    if (poolFailed)
+    {
+        fprintf(stderr, "[CBuilder Graph Error] Stopped with %d targets still running\n", running);
+        CBuild_JobPool_waitAll(pool); // collects the commands the pool can still wait for
+        return -2;
+    }
+
+    if (finished < count) // nothing running and nothing ready
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (nodes[i].state == CBUILD_NODE_PENDING)
+            {
+                fprintf(stderr, "[CBuilder Graph Error] Dependency cycle involving %s\n", CBuild_Graph_output(graph, i));
+                break;
+            }
+        }
+        return -1;
+    }
+
+    return graph->failed;
+}
+
+#endif // INCLUDED_CBUILDER_GRAPH
@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef INCLUDED_CBUILDER_INTERN
+#define INCLUDED_CBUILDER_INTERN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cbuilder_string.h"
+#include "cbuilder_arena.h"
+
+#define CBUILD_INTERN_NONE UINT32_MAX // id returned when a string is not interned
+
+typedef struct
+{
+    CBuild_Arena chars; // the interned strings, \0 terminated, blocks never move so views stay valid
+    const char **strs;  // string of each id
+    uint32_t *lens;     // length of each id
+    uint64_t *hashes;   // hash of each id, compared before the characters and reused on growth
+    uint32_t count;     // number of interned strings, ids are 0 to count - 1
+    uint32_t cap;       // allocated length of strs, lens and hashes
+
+    uint32_t *slots;  // open addressing table of id + 1, 0 if empty
+    uint32_t slotCap; // power of 2
+} CBuild_Intern;
+
+/**
+ * @brief Initialises an intern pool, which stores every distinct string once and gives it a dense id, so
+ *        paths and flags can be compared as integers
+ *
+ * @param intern The CBuild_Intern * to initialise, must be freed with CBuild_Intern_deinit
+ */
+void CBuild_Intern_init(CBuild_Intern *intern)
+{
+    CBuild_Arena_init(&intern->chars, 0);
+    intern->strs = NULL;
+    intern->lens = NULL;
+    intern->hashes = NULL;
+    intern->count = 0;
+    intern->cap = 0;
+
+    intern->slotCap = 64;
+    intern->slots = (uint32_t *)calloc(intern->slotCap, sizeof(uint32_t));
+}
+
+/**
+ * @brief Frees the intern pool, all ids and views become invalid
+ *
+ * @param intern The CBuild_Intern * to free
+ */
+void CBuild_Intern_deinit(CBuild_Intern *intern)
+{
+    CBuild_Arena_deinit(&intern->chars);
+    free(intern->strs);
+    free(intern->lens);
+    free(intern->hashes);
+    free(intern->slots);
+
+    intern->strs = NULL;
+    intern->lens = NULL;
+    intern->hashes = NULL;
+    intern->slots = NULL;
+    intern->count = 0;
+    intern->cap = 0;
+    intern->slotCap = 0;
+}
+
+// finds the slot holding view, or the empty slot it would go to
+uint32_t CBuild_Intern_slot(const CBuild_Intern *intern, CBuild_StrView view, uint64_t hash)
+{
+    uint32_t mask = intern->slotCap - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    while (intern->slots[slot])
+    {
+        uint32_t id = intern->slots[slot] - 1;
+        if (intern->hashes[id] == hash && intern->lens[id] == (uint32_t)view.len &&
+            (view.len == 0 || memcmp(intern->strs[id], view.str, view.len) == 0))
+        {
+            break;
+        }
+        slot = (slot + 1) & mask; // linear probing
+    }
+
+    return slot;
+}
+
+// doubles the table, the stored hashes are reused
+void CBuild_Intern_grow(CBuild_Intern *intern)
+{
+    uint32_t newCap = intern->slotCap * 2;
+    uint32_t *newSlots = (uint32_t *)calloc(newCap, sizeof(uint32_t));
+    for (uint32_t id = 0; id < intern->count; id++)
+    {
+        uint32_t slot = (uint32_t)intern->hashes[id] & (newCap - 1);
+        while (newSlots[slot])
+        {
+            slot = (slot + 1) & (newCap - 1);
+        }
+        newSlots[slot] = id + 1;
+    }
+
+    free(intern->slots);
+    intern->slots = newSlots;
+    intern->slotCap = newCap;
+}
+
+/**
+ * @brief Looks up a string without adding it
+ *
+ * @param intern The CBuild_Intern * to search
+ * @param view The CBuild_StrView of the string
+ * @return uint32_t The id of the string, CBUILD_INTERN_NONE if it was never interned
+ */
+uint32_t CBuild_Intern_find(const CBuild_Intern *intern, CBuild_StrView view)
+{
+    uint32_t slot = CBuild_Intern_slot(intern, view, CBuild_hash(view.str, view.len, 0));
+    return intern->slots[slot] ? intern->slots[slot] - 1 : CBUILD_INTERN_NONE;
+}
+
+/**
+ * @brief Interns a string, equal strings always get the same id and the characters are stored only once
+ *
+ * @param intern The CBuild_Intern * to add to
+ * @param view The CBuild_StrView of the string, copied into the pool if it is new
+ * @return uint32_t The stable id of the string, CBUILD_INTERN_NONE if out of memory
+ */
+uint32_t CBuild_Intern_addView(CBuild_Intern *intern, CBuild_StrView view)
+{
+    uint64_t hash = CBuild_hash(view.str, view.len, 0);
+    uint32_t slot = CBuild_Intern_slot(intern, view, hash);
+    if (intern->slots[slot])
+    {
+        return intern->slots[slot] - 1;
+    }
+
+    if (intern->count == intern->cap)
+    {
+        uint32_t newCap = intern->cap ? intern->cap * 2 : 64;
+        const char **strs = (const char **)realloc((void *)intern->strs, newCap * sizeof(const char *));
+        uint32_t *lens = (uint32_t *)realloc(intern->lens, newCap * sizeof(uint32_t));
+        uint64_t *hashes = (uint64_t *)realloc(intern->hashes, newCap * sizeof(uint64_t));
+        if (strs)
+        {
+            intern->strs = strs;
+        }
+        if (lens)
+        {
+            intern->lens = lens;
+        }
+        if (hashes)
+        {
+            intern->hashes = hashes;
+        }
+        if (!strs || !lens || !hashes)
+        {
+            fprintf(stderr, "[CBuilder Intern Error] Failed to grow the pool to %u strings\n", newCap);
+            return CBUILD_INTERN_NONE;
+        }
+        intern->cap = newCap;
+    }
+
+    char *str = CBuild_Arena_strdup(&intern->chars, view.str, view.len);
+    if (!str)
+    {
+        return CBUILD_INTERN_NONE;
+    }
+
+    uint32_t id = intern->count++;
+    intern->strs[id] = str;
+    intern->lens[id] = view.len;
+    intern->hashes[id] = hash;
+    intern->slots[slot] = id + 1;
+
+    if (intern->count * 4 > intern->slotCap * 3) // keep the load below 3/4
+    {
+        CBuild_Intern_grow(intern);
+    }
+
+    return id;
+}
+
+/**
+ * @brief Interns a \0 terminated string, see CBuild_Intern_addView
+ *
+ * @param intern The CBuild_Intern * to add to
+ * @param str The \0 terminated string
+ * @return uint32_t The stable id of the string, CBUILD_INTERN_NONE if out of memory
+ */
+uint32_t CBuild_Intern_add(CBuild_Intern *intern, const char *str)
+{
+    return CBuild_Intern_addView(intern, CBuild_StrView_fromCStr(str));
+}
+
+/**
+ * @brief Gets the interned string of an id as a view, which stays valid until CBuild_Intern_deinit
+ *
+ * @param intern The CBuild_Intern * holding the string
+ * @param id The id returned by CBuild_Intern_add
+ * @return CBuild_StrView The view of the interned string, the characters are also \0 terminated
+ */
+CBuild_StrView CBuild_Intern_view(const CBuild_Intern *intern, uint32_t id)
+{
+    return (CBuild_StrView){intern->strs[id], (int)intern->lens[id]};
+}
+
+/**
+ * @brief Gets the interned string of an id as a \0 terminated string, valid until CBuild_Intern_deinit
+ *
+ * @param intern The CBuild_Intern * holding the string
+ * @param id The id returned by CBuild_Intern_add
+ * @return const char* The interned string
+ */
+const char *CBuild_Intern_str(const CBuild_Intern *intern, uint32_t id)
+{
+    return intern->strs[id];
+}
+
+#endif // INCLUDED_CBUILDER_INTERN
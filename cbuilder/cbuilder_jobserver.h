@@ -0,0 +1,365 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#ifndef INCLUDED_CBUILDER_JOBSERVER
+#define INCLUDED_CBUILDER_JOBSERVER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cbuilder_string.h"
+
+/*
+ * The GNU make jobserver protocol, a shared pool of tokens (single bytes in a pipe or a named fifo) that caps the
+ * jobs of nested builds at one -j limit @n
+ * Every build owns one implicit token for its first job, each further parallel job first reads a token and writes
+ * the same byte back when the job is done @n
+ * Note: windows makes use a named semaphore instead, not supported, CBuild_Jobserver_connect and
+ * CBuild_Jobserver_create fail there without a message
+ */
+typedef struct
+{
+    int readFd;             // tokens are read from it without blocking, -1 if not connected
+    int writeFd;            // tokens are written back to it
+    int pollFirst;          // readFd blocks, tryAcquire checks it with poll first and reads under a timer
+    int openedFd;           // descriptor opened by this struct for reading, -1 if none
+    int pipeFds[2];         // pipe of an owned jobserver of the pipe form, -1 otherwise
+    CBuild_String fifoPath; // path of the fifo of an owned jobserver, empty otherwise
+} CBuild_Jobserver;
+
+/**
+ * @brief Connects to the jobserver of a parent make or CBuilder, from the --jobserver-auth option in MAKEFLAGS,
+ *        both the fifo:PATH form of make 4.4 and the R,W pipe form of older makes are understood @n
+ *        Note: for the pipe form the parent must pass its descriptors down, make does that for recipes marked
+ *        with '+' or running $(MAKE)
+ *
+ * @param js The CBuild_Jobserver * to connect, must be closed with CBuild_Jobserver_close
+ * @return int 0 if connected, -1 if there is no usable jobserver
+ */
+int CBuild_Jobserver_connect(CBuild_Jobserver *js);
+
+/**
+ * @brief Creates a jobserver with jobs tokens for the processes started from now on, the implicit token of
+ *        this process included, and exports it in MAKEFLAGS so sub-makes and nested CBuilder scripts share them
+ *
+ * @param js The CBuild_Jobserver * to create, must be closed with CBuild_Jobserver_close
+ * @param jobs The total number of parallel jobs of the whole build tree
+ * @param fifoPath The path of the fifo to create for the fifo form, NULL for the pipe form that also older
+ *        makes understand
+ * @return int 0 on success, -1 on failure
+ */
+int CBuild_Jobserver_create(CBuild_Jobserver *js, int jobs, const char *fifoPath);
+
+/**
+ * @brief Takes a token if one is available without waiting for it @n
+ *        Note: fifos and pipes reopened on linux are read without blocking, only the inherited pipe of the pipe
+ *        form on other systems blocks, it is read under a 10ms ITIMER_REAL whose SIGALRM interrupts the read
+ *        when another client took the token first, the handler and the timer of the caller are put back afterwards
+ *
+ * @param js The connected CBuild_Jobserver *
+ * @param token Set to the byte read, to be given back to CBuild_Jobserver_release
+ * @return int 1 if a token was taken, 0 if none is available now
+ */
+int CBuild_Jobserver_tryAcquire(CBuild_Jobserver *js, char *token);
+
+/**
+ * @brief Gives a token back to the jobserver
+ *
+ * @param js The connected CBuild_Jobserver *
+ * @param token The byte returned by CBuild_Jobserver_tryAcquire
+ */
+void CBuild_Jobserver_release(CBuild_Jobserver *js, char token);
+
+/**
+ * @brief Disconnects from the jobserver, all the tokens taken must be released first, an owned fifo is removed
+ *
+ * @param js The CBuild_Jobserver * to close
+ */
+void CBuild_Jobserver_close(CBuild_Jobserver *js);
+
+// finds the value of the last --jobserver-auth= (or the older --jobserver-fds=) in flags, make uses the last one
+CBuild_StrView CBuild_Jobserver_findAuth(const char *flags)
+{
+    const char *last = NULL;
+    int lastLen = 0;
+    const char *options[] = {"--jobserver-fds=", "--jobserver-auth="};
+    for (int i = 0; i < 2; i++)
+    {
+        for (const char *ptr = strstr(flags, options[i]); ptr; ptr = strstr(ptr + 1, options[i]))
+        {
+            if (ptr > last)
+            {
+                last = ptr;
+                lastLen = strlen(options[i]);
+            }
+        }
+    }
+
+    if (!last)
+    {
+        return (CBuild_StrView){NULL, 0};
+    }
+    return (CBuild_StrView){last + lastLen, (int)strcspn(last + lastLen, " ")};
+}
+
+// resets js to the unconnected state
+void CBuild_Jobserver_clear(CBuild_Jobserver *js)
+{
+    js->readFd = -1;
+    js->writeFd = -1;
+    js->pollFirst = 0;
+    js->openedFd = -1;
+    js->pipeFds[0] = -1;
+    js->pipeFds[1] = -1;
+    js->fifoPath = (CBuild_String){NULL, 0, 0};
+}
+
+#ifdef _WIN32
+
+int CBuild_Jobserver_connect(CBuild_Jobserver *js)
+{
+    CBuild_Jobserver_clear(js);
+    return -1;
+}
+
+int CBuild_Jobserver_create(CBuild_Jobserver *js, int jobs, const char *fifoPath)
+{
+    (void)jobs;
+    (void)fifoPath;
+    CBuild_Jobserver_clear(js); // silent, callers fall back to their own job limit
+    return -1;
+}
+
+int CBuild_Jobserver_tryAcquire(CBuild_Jobserver *js, char *token)
+{
+    (void)js;
+    (void)token;
+    return 0;
+}
+
+void CBuild_Jobserver_release(CBuild_Jobserver *js, char token)
+{
+    (void)js;
+    (void)token;
+}
+
+void CBuild_Jobserver_close(CBuild_Jobserver *js)
+{
+    (void)js;
+}
+
+#elif defined(__linux__) || defined(__APPLE__) || defined(__MACH__)
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// opens an own non blocking description of the pipe read end fd, so the mode does not leak to the other
+// processes sharing the pipe, only linux can reopen a pipe, elsewhere reads of fd are checked with poll first
+void CBuild_Jobserver_openPipe(CBuild_Jobserver *js, int fd)
+{
+    char procPath[64];
+    snprintf(procPath, sizeof(procPath), "/proc/self/fd/%d", fd);
+    js->openedFd = open(procPath, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    js->readFd = js->openedFd >= 0 ? js->openedFd : fd;
+    js->pollFirst = js->openedFd < 0;
+}
+
+int CBuild_Jobserver_connect(CBuild_Jobserver *js)
+{
+    CBuild_Jobserver_clear(js);
+
+    const char *flags = getenv("MAKEFLAGS");
+    CBuild_StrView auth = flags ? CBuild_Jobserver_findAuth(flags) : (CBuild_StrView){NULL, 0};
+    if (!auth.str)
+    {
+        return -1;
+    }
+
+    CBuild_String value = CBuild_String_initView(auth);
+    int readFd, writeFd;
+    if (strncmp(value.str, "fifo:", 5) == 0)
+    {
+        js->openedFd = open(value.str + 5, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        js->readFd = js->openedFd;
+        js->writeFd = js->openedFd;
+        if (js->openedFd < 0)
+        {
+            fprintf(stderr, "[CBuilder Jobserver Error] Failed to open %s: %s\n", value.str + 5, strerror(errno));
+        }
+    }
+    else if (sscanf(value.str, "%d,%d", &readFd, &writeFd) == 2 && readFd >= 0 && writeFd >= 0 &&
+             fcntl(readFd, F_GETFD) >= 0 && fcntl(writeFd, F_GETFD) >= 0)
+    {
+        CBuild_Jobserver_openPipe(js, readFd);
+        js->writeFd = writeFd;
+    }
+    else // make passes the option without the descriptors to recipes it does not know to be recursive
+    {
+        fprintf(stderr, "[CBuilder Jobserver Error] The jobserver %s is not available, mark the make rule with '+'\n",
+                value.str);
+    }
+
+    CBuild_String_deinit(&value);
+    return js->readFd >= 0 ? 0 : -1;
+}
+
+int CBuild_Jobserver_create(CBuild_Jobserver *js, int jobs, const char *fifoPath)
+{
+    CBuild_Jobserver_clear(js);
+    char auth[64];
+    if (fifoPath)
+    {
+        remove(fifoPath); // a stale fifo of a crashed build
+        if (mkfifo(fifoPath, 0600) == 0)
+        {
+            js->fifoPath = CBuild_String_init(fifoPath);
+            js->openedFd = open(fifoPath, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            js->readFd = js->openedFd;
+            js->writeFd = js->openedFd;
+        }
+        snprintf(auth, sizeof(auth), " -j%d --jobserver-auth=fifo:", jobs);
+    }
+    else if (pipe(js->pipeFds) == 0) // inherited by the children, unlike all the other descriptors
+    {
+        CBuild_Jobserver_openPipe(js, js->pipeFds[0]);
+        js->writeFd = js->pipeFds[1];
+        snprintf(auth, sizeof(auth), " -j%d --jobserver-auth=%d,%d", jobs, js->pipeFds[0], js->pipeFds[1]);
+    }
+
+    if (js->readFd < 0)
+    {
+        fprintf(stderr, "[CBuilder Jobserver Error] Failed to create the jobserver: %s\n", strerror(errno));
+        CBuild_Jobserver_close(js);
+        return -1;
+    }
+
+    for (int i = 1; i < jobs; i++) // one token less, this process holds the implicit one
+    {
+        CBuild_Jobserver_release(js, '+');
+    }
+
+    const char *flags = getenv("MAKEFLAGS");
+    CBuild_String makeFlags = CBuild_String_init(flags ? flags : "");
+    CBuild_String_concatCStr(&makeFlags, auth);
+    if (fifoPath)
+    {
+        CBuild_String_concatCStr(&makeFlags, fifoPath);
+    }
+    setenv("MAKEFLAGS", makeFlags.str, 1);
+    CBuild_String_deinit(&makeFlags);
+    return 0;
+}
+
+// does nothing, a SIGALRM only has to interrupt a read of the jobserver
+void CBuild_Jobserver_onAlarm(int signal)
+{
+    (void)signal;
+}
+
+int CBuild_Jobserver_tryAcquire(CBuild_Jobserver *js, char *token)
+{
+    if (!js->pollFirst)
+    {
+        for (;;)
+        {
+            ssize_t len = read(js->readFd, token, 1);
+            if (len == 1)
+            {
+                return 1;
+            }
+            if (len < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return 0;
+        }
+    }
+
+    struct pollfd fd = {js->readFd, POLLIN, 0};
+    if (poll(&fd, 1, 0) <= 0)
+    {
+        return 0;
+    }
+
+    // another client may take the token between the poll and the read, as GNU make does the read is then
+    // interrupted by a timer, repeating so an alarm that fires just before the read cannot leave it blocked
+    struct sigaction action, previousAction;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = CBuild_Jobserver_onAlarm;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0; // no SA_RESTART, the read fails with EINTR
+    sigaction(SIGALRM, &action, &previousAction);
+
+    struct itimerval timer = {{0, 10000}, {0, 10000}}, previousTimer;
+    setitimer(ITIMER_REAL, &timer, &previousTimer);
+    ssize_t len = read(js->readFd, token, 1);
+
+    // the timer stops before the handler is put back, so none of its alarms reaches the handler of the caller
+    setitimer(ITIMER_REAL, &previousTimer, NULL);
+    sigaction(SIGALRM, &previousAction, NULL);
+    return len == 1;
+}
+
+void CBuild_Jobserver_release(CBuild_Jobserver *js, char token)
+{
+    while (write(js->writeFd, &token, 1) < 0 && errno == EINTR)
+        ;
+}
+
+void CBuild_Jobserver_close(CBuild_Jobserver *js)
+{
+    if (js->openedFd >= 0)
+    {
+        close(js->openedFd);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (js->pipeFds[i] >= 0)
+        {
+            close(js->pipeFds[i]);
+        }
+    }
+    if (js->fifoPath.str)
+    {
+        remove(js->fifoPath.str);
+        CBuild_String_deinit(&js->fifoPath);
+    }
+
+    CBuild_Jobserver_clear(js);
+}
+
+#else // unsupported system
+#error "[CBuilder Jobserver] Unsupported system, if you know about your system, feel free to define _WIN32 for windows __linux__ or __APPLE__ or __MACH__ for linux and mac systems"
+#endif
+
+#endif // INCLUDED_CBUILDER_JOBSERVER
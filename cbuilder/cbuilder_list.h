@@ -27,14 +27,19 @@ SOFTWARE.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cbuilder_string.h"
 
 #define MAX_ITERATION 1000000 // dont go above this iteration limit
 
-typedef struct
+typedef struct CBuilder_List
 {
     void *data;
     
-    CBuilder_List* next;
+    struct CBuilder_List *next;
 } CBuilder_List;
 
 CBuilder_List *CBuilder_List_init(void *data)
@@ -55,6 +60,14 @@ void CBuilder_List_deinit(CBuilder_List *root)
     }
 }
 
+/**
+ * @brief Appends data to the end of the list, this walks the whole list so filling a list is O(n^2) @n
+ *        Note: prefer CBuild_Vec, or CBuild_IList for linked nodes, which append in O(1)
+ *
+ * @param root Any node of the list, the walk starts from it
+ * @param data The data of the new node
+ * @return CBuilder_List* The new last node, NULL if the list is longer than MAX_ITERATION
+ */
 CBuilder_List *CBuilder_List_pushBack(CBuilder_List *root, void *data)
 {
     int i = 0;
@@ -77,4 +90,599 @@ CBuilder_List *CBuilder_List_pushBack(CBuilder_List *root, void *data)
     return root->next;
 }
 
-#endif // INCLUDED_CBUILDER_LIST
\ No newline at end of file
+typedef struct
+{
+    void *data;      // elements stored back to back
+    size_t elemSize; // size of one element in bytes
+    int count;       // number of elements
+    int cap;         // allocated number of elements
+} CBuild_Vec;
+
+#define CBUILD_VEC_AT(vec, type, i) (((type *)(vec)->data)[i]) // typed access to element i
+
+/**
+ * @brief Initialises a growable array of elements of elemSize bytes, nothing is allocated until the first push
+ *
+ * @param vec The CBuild_Vec * to initialise, must be freed with CBuild_Vec_deinit
+ * @param elemSize The size of one element, for example sizeof(CBuild_String)
+ */
+void CBuild_Vec_init(CBuild_Vec *vec, size_t elemSize)
+{
+    vec->data = NULL;
+    vec->elemSize = elemSize;
+    vec->count = 0;
+    vec->cap = 0;
+}
+
+/**
+ * @brief Frees the elements array, the elements themselves are not freed
+ *
+ * @param vec The CBuild_Vec * to free
+ */
+void CBuild_Vec_deinit(CBuild_Vec *vec)
+{
+    free(vec->data);
+    vec->data = NULL;
+    vec->count = 0;
+    vec->cap = 0;
+}
+
+/**
+ * @brief Makes sure the vector can hold atleast cap elements without reallocating
+ *
+ * @param vec The CBuild_Vec * to grow
+ * @param cap The number of elements to make room for
+ * @return int 0 on success, -1 if out of memory
+ */
+int CBuild_Vec_reserve(CBuild_Vec *vec, int cap)
+{
+    if (cap <= vec->cap)
+    {
+        return 0;
+    }
+
+    int newCap = vec->cap ? vec->cap * 2 : 16; // geometric, so a push is amortized O(1)
+    if (newCap < cap)
+    {
+        newCap = cap;
+    }
+
+    void *data = realloc(vec->data, (size_t)newCap * vec->elemSize);
+    if (!data)
+    {
+        fprintf(stderr, "[CBuilder Vec Error] Failed to grow to %d elements\n", newCap);
+        return -1;
+    }
+
+    vec->data = data;
+    vec->cap = newCap;
+    return 0;
+}
+
+/**
+ * @brief Gets a pointer to element i, valid until the next push or reserve
+ *
+ * @param vec The CBuild_Vec * to read from
+ * @param i The index of the element, 0 to count - 1
+ * @return void* The pointer to the element
+ */
+void *CBuild_Vec_at(const CBuild_Vec *vec, int i)
+{
+    return (char *)vec->data + (size_t)i * vec->elemSize;
+}
+
+/**
+ * @brief Appends an element in amortized O(1)
+ *
+ * @param vec The CBuild_Vec * to append to
+ * @param elem The element to copy in, NULL to append a zeroed element
+ * @return void* The pointer to the new element, NULL if out of memory
+ */
+void *CBuild_Vec_push(CBuild_Vec *vec, const void *elem)
+{
+    if (CBuild_Vec_reserve(vec, vec->count + 1))
+    {
+        return NULL;
+    }
+
+    void *slot = CBuild_Vec_at(vec, vec->count++);
+    if (elem)
+    {
+        memcpy(slot, elem, vec->elemSize);
+    }
+    else
+    {
+        memset(slot, 0, vec->elemSize);
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Removes the last element
+ *
+ * @param vec The CBuild_Vec * to remove from
+ * @param elem Where to copy the removed element, may be NULL
+ * @return int 0 on success, -1 if the vector is empty
+ */
+int CBuild_Vec_pop(CBuild_Vec *vec, void *elem)
+{
+    if (vec->count == 0)
+    {
+        return -1;
+    }
+
+    vec->count--;
+    if (elem)
+    {
+        memcpy(elem, CBuild_Vec_at(vec, vec->count), vec->elemSize);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Removes element i by moving the last element into its place, O(1) but does not keep the order
+ *
+ * @param vec The CBuild_Vec * to remove from
+ * @param i The index of the element to remove
+ */
+void CBuild_Vec_swapRemove(CBuild_Vec *vec, int i)
+{
+    vec->count--;
+    if (i != vec->count)
+    {
+        memcpy(CBuild_Vec_at(vec, i), CBuild_Vec_at(vec, vec->count), vec->elemSize);
+    }
+}
+
+/**
+ * @brief Removes all the elements, the allocation is kept for reuse
+ *
+ * @param vec The CBuild_Vec * to clear
+ */
+void CBuild_Vec_clear(CBuild_Vec *vec)
+{
+    vec->count = 0;
+}
+
+#define CBUILD_CONTAINER_OF(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+
+typedef struct CBuild_ListLink
+{
+    struct CBuild_ListLink *next;
+} CBuild_ListLink; // embed in a struct to link it into a CBuild_IList without extra allocations
+
+typedef struct
+{
+    CBuild_ListLink *head;
+    CBuild_ListLink *tail; // last link, so appending does not walk the list
+    int count;
+} CBuild_IList;
+
+/**
+ * @brief Initialises an intrusive singly linked list, the nodes are owned by the caller and link through
+ *        an embedded CBuild_ListLink, use CBUILD_CONTAINER_OF to get back to the node
+ *
+ * @param list The CBuild_IList * to initialise, nothing to free
+ */
+void CBuild_IList_init(CBuild_IList *list)
+{
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+}
+
+/**
+ * @brief Appends a link to the end of the list in O(1)
+ *
+ * @param list The CBuild_IList * to append to
+ * @param link The CBuild_ListLink * embedded in the node, must not be in a list already
+ */
+void CBuild_IList_pushBack(CBuild_IList *list, CBuild_ListLink *link)
+{
+    link->next = NULL;
+    if (list->tail)
+    {
+        list->tail->next = link;
+    }
+    else
+    {
+        list->head = link;
+    }
+
+    list->tail = link;
+    list->count++;
+}
+
+/**
+ * @brief Prepends a link to the start of the list in O(1)
+ *
+ * @param list The CBuild_IList * to prepend to
+ * @param link The CBuild_ListLink * embedded in the node, must not be in a list already
+ */
+void CBuild_IList_pushFront(CBuild_IList *list, CBuild_ListLink *link)
+{
+    link->next = list->head;
+    list->head = link;
+    if (!list->tail)
+    {
+        list->tail = link;
+    }
+    list->count++;
+}
+
+/**
+ * @brief Removes the first link of the list in O(1), which makes the list a FIFO queue with pushBack
+ *
+ * @param list The CBuild_IList * to remove from
+ * @return CBuild_ListLink* The removed link, NULL if the list is empty
+ */
+CBuild_ListLink *CBuild_IList_popFront(CBuild_IList *list)
+{
+    CBuild_ListLink *link = list->head;
+    if (!link)
+    {
+        return NULL;
+    }
+
+    list->head = link->next;
+    if (!list->head)
+    {
+        list->tail = NULL;
+    }
+    list->count--;
+
+    link->next = NULL;
+    return link;
+}
+
+typedef uint64_t (*CBuild_HashFn)(const void *key, size_t keySize);
+typedef int (*CBuild_EqualsFn)(const void *key1, const void *key2, size_t keySize);
+
+typedef struct
+{
+    char *slots;      // cap slots of stride bytes: the uint64_t hash (0 if empty), the key, then the value
+    char *scratch;    // room for two slots, used while entries are swapped
+    size_t keySize;
+    size_t valueSize;
+    size_t stride;  // bytes per slot, a multiple of 8 so the hashes stay aligned
+    uint32_t count; // number of entries
+    uint32_t cap;   // number of slots, power of 2
+    CBuild_HashFn hash;
+    CBuild_EqualsFn equals;
+} CBuild_HashMap;
+
+// default hash, the key bytes themselves
+uint64_t CBuild_HashMap_hashBytes(const void *key, size_t keySize)
+{
+    return CBuild_hash(key, keySize, 0);
+}
+
+// default equality, the key bytes themselves
+int CBuild_HashMap_equalsBytes(const void *key1, const void *key2, size_t keySize)
+{
+    return memcmp(key1, key2, keySize) == 0;
+}
+
+// hash for keys that are const char * to \0 terminated strings, keySize must be sizeof(const char *)
+uint64_t CBuild_HashMap_hashCStr(const void *key, size_t keySize)
+{
+    (void)keySize;
+    const char *str = *(const char *const *)key;
+    return CBuild_hash(str, strlen(str), 0);
+}
+
+// equality for keys that are const char * to \0 terminated strings
+int CBuild_HashMap_equalsCStr(const void *key1, const void *key2, size_t keySize)
+{
+    (void)keySize;
+    return strcmp(*(const char *const *)key1, *(const char *const *)key2) == 0;
+}
+
+// hash for keys that are CBuild_StrView, keySize must be sizeof(CBuild_StrView)
+uint64_t CBuild_HashMap_hashView(const void *key, size_t keySize)
+{
+    (void)keySize;
+    const CBuild_StrView *view = (const CBuild_StrView *)key;
+    return CBuild_hash(view->str, view->len, 0);
+}
+
+// equality for keys that are CBuild_StrView
+int CBuild_HashMap_equalsView(const void *key1, const void *key2, size_t keySize)
+{
+    (void)keySize;
+    return CBuild_StrView_equals(*(const CBuild_StrView *)key1, *(const CBuild_StrView *)key2);
+}
+
+// the hash, key and value of a slot are stored together, so a probe touches one cache line
+#define CBUILD_HASHMAP_SLOT(map, i) ((map)->slots + (size_t)(i) * (map)->stride)
+#define CBUILD_HASHMAP_HASH(map, i) (*(uint64_t *)CBUILD_HASHMAP_SLOT(map, i))
+#define CBUILD_HASHMAP_KEY(map, i) (CBUILD_HASHMAP_SLOT(map, i) + sizeof(uint64_t))
+#define CBUILD_HASHMAP_VALUE(map, i) (CBUILD_HASHMAP_KEY(map, i) + (map)->keySize)
+
+/**
+ * @brief Initialises a generic open addressing hash map with Robin Hood probing, keys and values are copied
+ *        into the map by value, so for string keys store a const char * or CBuild_StrView whose characters
+ *        outlive the map (for example interned with CBuild_Intern) together with the matching hash functions
+ *
+ * @param map The CBuild_HashMap * to initialise, must be freed with CBuild_HashMap_deinit
+ * @param keySize The size of a key in bytes
+ * @param valueSize The size of a value in bytes, 0 to use the map as a set
+ * @param hash The hash function of the keys, NULL to hash the key bytes, or CBuild_HashMap_hashCStr / _hashView
+ * @param equals The equality of the keys, NULL to compare the key bytes, or CBuild_HashMap_equalsCStr / _equalsView
+ * @return int 0 on success, -1 if out of memory
+ */
+int CBuild_HashMap_init(CBuild_HashMap *map, size_t keySize, size_t valueSize, CBuild_HashFn hash, CBuild_EqualsFn equals)
+{
+    map->keySize = keySize;
+    map->valueSize = valueSize;
+    map->stride = (sizeof(uint64_t) + keySize + valueSize + 7) & ~(size_t)7;
+    map->count = 0;
+    map->cap = 16;
+    map->hash = hash ? hash : CBuild_HashMap_hashBytes;
+    map->equals = equals ? equals : CBuild_HashMap_equalsBytes;
+    map->slots = (char *)calloc(map->cap, map->stride);
+    map->scratch = (char *)malloc(2 * map->stride);
+
+    if (!map->slots || !map->scratch)
+    {
+        fprintf(stderr, "[CBuilder HashMap Error] Failed to allocate the map\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Frees the map, the keys and values are not freed
+ *
+ * @param map The CBuild_HashMap * to free
+ */
+void CBuild_HashMap_deinit(CBuild_HashMap *map)
+{
+    free(map->slots);
+    free(map->scratch);
+    map->slots = NULL;
+    map->scratch = NULL;
+    map->count = 0;
+    map->cap = 0;
+}
+
+// hash of a key as stored in the slots, never 0
+uint64_t CBuild_HashMap_keyHash(const CBuild_HashMap *map, const void *key)
+{
+    uint64_t h = map->hash(key, map->keySize);
+    return h ? h : 1;
+}
+
+// distance of slot from the home slot of the hash stored in it
+uint32_t CBuild_HashMap_dist(const CBuild_HashMap *map, uint32_t slot)
+{
+    return (slot - (uint32_t)CBUILD_HASHMAP_HASH(map, slot)) & (map->cap - 1);
+}
+
+// finds the slot of key, -1 if it is not in the map
+int64_t CBuild_HashMap_find(const CBuild_HashMap *map, const void *key)
+{
+    uint64_t h = CBuild_HashMap_keyHash(map, key);
+    uint32_t mask = map->cap - 1;
+    uint32_t slot = (uint32_t)h & mask;
+    for (uint32_t dist = 0;; dist++, slot = (slot + 1) & mask)
+    {
+        // an empty slot, or an entry closer to its home than we are to ours, ends the search
+        uint64_t slotHash = CBUILD_HASHMAP_HASH(map, slot);
+        if (!slotHash || CBuild_HashMap_dist(map, slot) < dist)
+        {
+            return -1;
+        }
+
+        if (slotHash == h && map->equals(CBUILD_HASHMAP_KEY(map, slot), key, map->keySize))
+        {
+            return slot;
+        }
+    }
+}
+
+// places the entry in scratch, known not to be in the map, returns the slot it went to
+uint32_t CBuild_HashMap_insertScratch(CBuild_HashMap *map)
+{
+    char *cur = map->scratch;
+    char *tmp = map->scratch + map->stride;
+    uint64_t h = *(uint64_t *)cur;
+
+    uint32_t mask = map->cap - 1;
+    uint32_t slot = (uint32_t)h & mask;
+    uint32_t placed = UINT32_MAX;
+    for (uint32_t dist = 0;; dist++, slot = (slot + 1) & mask)
+    {
+        char *slotPtr = CBUILD_HASHMAP_SLOT(map, slot);
+        if (!*(uint64_t *)slotPtr)
+        {
+            memcpy(slotPtr, cur, map->stride);
+            return placed == UINT32_MAX ? slot : placed;
+        }
+
+        uint32_t slotDist = CBuild_HashMap_dist(map, slot);
+        if (slotDist < dist) // robin hood: take the slot from the richer entry and carry that one on
+        {
+            memcpy(tmp, slotPtr, map->stride);
+            memcpy(slotPtr, cur, map->stride);
+            memcpy(cur, tmp, map->stride);
+
+            if (placed == UINT32_MAX)
+            {
+                placed = slot;
+            }
+            dist = slotDist;
+        }
+    }
+}
+
+// moves every entry to a table of newCap slots, reusing the stored hashes
+int CBuild_HashMap_rehash(CBuild_HashMap *map, uint32_t newCap)
+{
+    char *oldSlots = map->slots;
+    uint32_t oldCap = map->cap;
+
+    char *slots = (char *)calloc(newCap, map->stride);
+    if (!slots)
+    {
+        fprintf(stderr, "[CBuilder HashMap Error] Failed to grow to %u slots\n", newCap);
+        return -1;
+    }
+
+    map->slots = slots;
+    map->cap = newCap;
+    for (uint32_t i = 0; i < oldCap; i++)
+    {
+        char *slotPtr = oldSlots + (size_t)i * map->stride;
+        if (*(uint64_t *)slotPtr)
+        {
+            memcpy(map->scratch, slotPtr, map->stride);
+            CBuild_HashMap_insertScratch(map);
+        }
+    }
+
+    free(oldSlots);
+    return 0;
+}
+
+/**
+ * @brief Makes room for count entries, so filling the map up to count never rehashes
+ *
+ * @param map The CBuild_HashMap * to grow
+ * @param count The number of entries to make room for
+ * @return int 0 on success, -1 if out of memory
+ */
+int CBuild_HashMap_reserve(CBuild_HashMap *map, uint32_t count)
+{
+    uint32_t cap = map->cap;
+    while ((uint64_t)count * 5 > (uint64_t)cap * 4)
+    {
+        cap *= 2;
+    }
+
+    return cap == map->cap ? 0 : CBuild_HashMap_rehash(map, cap);
+}
+
+/**
+ * @brief Looks up a key
+ *
+ * @param map The CBuild_HashMap * to search
+ * @param key The pointer to the key
+ * @return void* The pointer to the value of key in the map, valid until the next put or remove, NULL if not found
+ */
+void *CBuild_HashMap_get(const CBuild_HashMap *map, const void *key)
+{
+    int64_t slot = CBuild_HashMap_find(map, key);
+    return slot < 0 ? NULL : CBUILD_HASHMAP_VALUE(map, slot);
+}
+
+/**
+ * @brief Checks if the map holds key
+ *
+ * @param map The CBuild_HashMap * to search
+ * @param key The pointer to the key
+ * @return int 1 if the key is in the map, 0 if not
+ */
+int CBuild_HashMap_contains(const CBuild_HashMap *map, const void *key)
+{
+    return CBuild_HashMap_find(map, key) >= 0;
+}
+
+/**
+ * @brief Inserts key with value, or overwrites the value if key is already in the map
+ *
+ * @param map The CBuild_HashMap * to insert into
+ * @param key The pointer to the key, copied into the map
+ * @param value The pointer to the value, copied into the map, may be NULL for sets or to zero the value
+ * @return void* The pointer to the value in the map, valid until the next put or remove, NULL if out of memory
+ */
+void *CBuild_HashMap_put(CBuild_HashMap *map, const void *key, const void *value)
+{
+    int64_t found = CBuild_HashMap_find(map, key);
+    if (found < 0)
+    {
+        if ((map->count + 1) * 5 > map->cap * 4 && CBuild_HashMap_rehash(map, map->cap * 2)) // keep the load below 4/5
+        {
+            return NULL;
+        }
+
+        char *entry = map->scratch;
+        *(uint64_t *)entry = CBuild_HashMap_keyHash(map, key);
+        memcpy(entry + sizeof(uint64_t), key, map->keySize);
+        found = CBuild_HashMap_insertScratch(map);
+        map->count++;
+    }
+
+    char *slotValue = CBUILD_HASHMAP_VALUE(map, found);
+    if (map->valueSize)
+    {
+        value ? memcpy(slotValue, value, map->valueSize) : memset(slotValue, 0, map->valueSize);
+    }
+    return slotValue;
+}
+
+/**
+ * @brief Removes key from the map, the following entries are shifted back so no tombstones are left
+ *
+ * @param map The CBuild_HashMap * to remove from
+ * @param key The pointer to the key
+ * @return int 1 if the key was removed, 0 if it was not in the map
+ */
+int CBuild_HashMap_remove(CBuild_HashMap *map, const void *key)
+{
+    int64_t found = CBuild_HashMap_find(map, key);
+    if (found < 0)
+    {
+        return 0;
+    }
+
+    uint32_t mask = map->cap - 1;
+    uint32_t slot = (uint32_t)found;
+    uint32_t next = (slot + 1) & mask;
+    while (CBUILD_HASHMAP_HASH(map, next) && CBuild_HashMap_dist(map, next) > 0)
+    {
+        memcpy(CBUILD_HASHMAP_SLOT(map, slot), CBUILD_HASHMAP_SLOT(map, next), map->stride);
+        slot = next;
+        next = (next + 1) & mask;
+    }
+
+    CBUILD_HASHMAP_HASH(map, slot) = 0;
+    map->count--;
+    return 1;
+}
+
+/**
+ * @brief Iterates the entries of the map in no particular order, the map must not be changed while iterating @n
+ *        Example: uint32_t it = 0; while (CBuild_HashMap_next(&map, &it, &key, &value)) { ... }
+ *
+ * @param map The CBuild_HashMap * to iterate
+ * @param iter The iterator state, must be set to 0 before the first call
+ * @param key Where to store the pointer to the key of the entry, may be NULL
+ * @param value Where to store the pointer to the value of the entry, may be NULL
+ * @return int 1 if an entry was found, 0 at the end
+ */
+int CBuild_HashMap_next(const CBuild_HashMap *map, uint32_t *iter, void **key, void **value)
+{
+    while (*iter < map->cap)
+    {
+        uint32_t slot = (*iter)++;
+        if (CBUILD_HASHMAP_HASH(map, slot))
+        {
+            if (key)
+            {
+                *key = CBUILD_HASHMAP_KEY(map, slot);
+            }
+            if (value)
+            {
+                *value = CBUILD_HASHMAP_VALUE(map, slot);
+            }
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#endif // INCLUDED_CBUILDER_LIST
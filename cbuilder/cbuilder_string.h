@@ -28,8 +28,37 @@ SOFTWARE.
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdarg.h>
 
 #define CBUILDER_BUF_CHUNK (256)
+#define CBUILDER_SMALL_BUF (64)         // buffer size of short strings, served from a per thread cache
+#ifndef CBUILDER_SMALL_POOL_MAX
+#define CBUILDER_SMALL_POOL_MAX (4096)  // maximum number of cached short string buffers per thread, 0 disables the cache
+#endif
+
+#ifdef _MSC_VER
+#define CBUILD_THREAD_LOCAL __declspec(thread)
+#else
+#define CBUILD_THREAD_LOCAL _Thread_local
+#endif
+
+// counts the heap calls of the string layer when compiled with CBUILDER_STATS, not thread safe
+typedef struct
+{
+    long mallocs;
+    long reallocs;
+    long frees;
+    long poolHits; // short string buffers reused from the cache instead of malloc
+} CBuild_AllocStats;
+
+CBuild_AllocStats CBuild_allocStats;
+
+#ifdef CBUILDER_STATS
+#define CBUILD_STAT(field) (CBuild_allocStats.field++)
+#else
+#define CBUILD_STAT(field) ((void)0)
+#endif
 
 typedef struct
 {
@@ -38,37 +67,134 @@ typedef struct
     int buf_len; // actual length of the buffer
 } CBuild_String;
 
+// per thread free list of CBUILDER_SMALL_BUF sized buffers, linked through their first bytes
+CBUILD_THREAD_LOCAL char *CBuild_smallPool = NULL;
+CBUILD_THREAD_LOCAL int CBuild_smallPoolCount = 0;
+
+// returns a CBUILDER_SMALL_BUF sized buffer, from the cache if possible
+char *CBuild_String_allocSmall()
+{
+    char *mem = CBuild_smallPool;
+    if (mem)
+    {
+        memcpy(&CBuild_smallPool, mem, sizeof(char *));
+        CBuild_smallPoolCount--;
+        CBUILD_STAT(poolHits);
+        return mem;
+    }
+
+    CBUILD_STAT(mallocs);
+    return (char *)malloc(CBUILDER_SMALL_BUF);
+}
+
+// frees a string buffer, short ones are kept in the cache for the next string
+void CBuild_String_freeBuf(char *mem, int buf_len)
+{
+    if (buf_len == CBUILDER_SMALL_BUF && CBuild_smallPoolCount < CBUILDER_SMALL_POOL_MAX)
+    {
+        memcpy(mem, &CBuild_smallPool, sizeof(char *));
+        CBuild_smallPool = mem;
+        CBuild_smallPoolCount++;
+        return;
+    }
+
+    CBUILD_STAT(frees);
+    free(mem);
+}
+
 /**
- * @brief Initialises the CBuild_String struct with a heap alocated string with appropriate memory
+ * @brief Frees the short string buffers cached by the calling thread, threads using CBuild_String should call
+ *        this before exiting so the cache is not leaked
+ */
+void CBuild_String_releasePool()
+{
+    while (CBuild_smallPool)
+    {
+        char *mem = CBuild_smallPool;
+        memcpy(&CBuild_smallPool, mem, sizeof(char *));
+        CBUILD_STAT(frees);
+        free(mem);
+    }
+
+    CBuild_smallPoolCount = 0;
+}
+
+/**
+ * @brief Makes sure the buffer of str can hold atleast capacity bytes including the ending \0, the buffer grows
+ *        geometrically (doubling, in multiples of CBUILDER_BUF_CHUNK) through realloc, so appending n bytes in
+ *        small pieces costs O(n) in total @n
+ *        Note: a token from CBuild_String_tokenizer (buf_len of 0) does not own its memory, it is copied into
+ *        a new buffer of its own instead
  *
- * @param src The source string to initialise with, must be null terminated, or else will lead to undefined behaviour
- * @return CBuild_String The struct containing data about the string
+ * @param str The CBuild_String * to grow
+ * @param capacity The number of bytes needed, including the ending \0
+ * @return CBuild_String* The reference to str
  */
-CBuild_String CBuild_String_init(const char *src)
+CBuild_String *CBuild_String_reserve(CBuild_String *str, int capacity)
 {
-    unsigned int count;
-    int len = strlen(src);
-    if (len == 0)
+    if (str->buf_len >= capacity)
     {
-        count = 1;
+        return str;
     }
-    else
+
+    int buf_len = str->buf_len * 2;
+    if (buf_len < capacity)
     {
-        count = len / CBUILDER_BUF_CHUNK;
-        if (len % CBUILDER_BUF_CHUNK) // allocate extra for spill
+        buf_len = capacity;
+    }
+    buf_len = (buf_len + CBUILDER_BUF_CHUNK - 1) / CBUILDER_BUF_CHUNK * CBUILDER_BUF_CHUNK;
+
+    if (str->buf_len == 0) // container string or empty struct, nothing to free
+    {
+        char *newMem;
+        if (capacity <= CBUILDER_SMALL_BUF) // most paths and flags are short, they skip malloc once the cache is warm
         {
-            count++;
+            buf_len = CBUILDER_SMALL_BUF;
+            newMem = CBuild_String_allocSmall();
         }
+        else
+        {
+            CBUILD_STAT(mallocs);
+            newMem = (char *)malloc(buf_len);
+        }
+
+        if (str->str)
+        {
+            memcpy(newMem, str->str, str->len);
+        }
+        else
+        {
+            str->len = 0;
+        }
+        newMem[str->len] = '\0';
+        str->str = newMem;
+    }
+    else
+    {
+        CBUILD_STAT(reallocs);
+        str->str = (char *)realloc(str->str, buf_len); // short strings leave the cache here
     }
 
-    int buf_len = CBUILDER_BUF_CHUNK * count;
-    char *newMem = (char *)malloc(buf_len); // generate and copy the provided string to heap string
-    memcpy(newMem, src, len + 1);
+    str->buf_len = buf_len;
+    return str;
+}
+
+/**
+ * @brief Appends len bytes of src to str and keeps it \0 terminated, the single growth path of all the concat calls
+ *
+ * @param str The CBuild_String * to append to
+ * @param src The bytes to append, need not be \0 terminated
+ * @param len The number of bytes to append
+ * @return CBuild_String* The reference to str
+ */
+CBuild_String *CBuild_String_append(CBuild_String *str, const char *src, int len)
+{
+    CBuild_String_reserve(str, str->len + len + 1);
+    memmove(str->str + str->len, src, len); // src may be a part of str itself
+    str->len += len;
+    str->str[str->len] = '\0';
 
-    return (CBuild_String){
-        newMem,
-        len,
-        buf_len};
+    return str;
 }
 
 /**
@@ -80,55 +206,59 @@ CBuild_String CBuild_String_init(const char *src)
  */
 CBuild_String CBuild_String_initN(const char *src, int len)
 {
-    unsigned int count;
-    if (len == 0)
+    const char *end = (const char *)memchr(src, '\0', len); // copy atmost upto the end of src
+    if (end)
     {
-        count = 1;
+        len = end - src;
     }
-    else
-    {
-        count = len / CBUILDER_BUF_CHUNK;
-        if (len % CBUILDER_BUF_CHUNK) // allocate extra for spill
-        {
-            count++;
-        }
-    }
-
-    int buf_len = CBUILDER_BUF_CHUNK * count;
-    char *newMem = (char *)malloc(buf_len); // generate and copy the provided string to heap string
 
-    int srcLen = strlen(src);
-    memcpy(newMem, src, (srcLen > len ? len : srcLen) + 1);
-
-    newMem[len] = '\0'; // make sure the last bit is \0
+    CBuild_String str = {NULL, 0, 0};
+    CBuild_String_reserve(&str, len + 1);
+    return *CBuild_String_append(&str, src, len);
+}
 
-    return (CBuild_String){
-        newMem,
-        len,
-        buf_len};
+/**
+ * @brief Initialises the CBuild_String struct with a heap alocated string with appropriate memory
+ *
+ * @param src The source string to initialise with, must be null terminated, or else will lead to undefined behaviour
+ * @return CBuild_String The struct containing data about the string
+ */
+CBuild_String CBuild_String_init(const char *src)
+{
+    return CBuild_String_initN(src, strlen(src));
 }
 
 /**
- * @brief Standard call for cstd free for char *str, also sets the internal states to 0
+ * @brief Standard call for cstd free for char *str, also sets the internal states to 0 @n
+ *        Note: container strings (buf_len 0, tokens or arena strings) do not own their memory and are not freed
  *
  * @param str The CBuild_String ref to free
  */
 void CBuild_String_deinit(CBuild_String *str)
 {
-    free(str->str);
+    if (str->str && str->buf_len)
+    {
+        CBuild_String_freeBuf(str->str, str->buf_len);
+    }
     str->len = 0;
     str->buf_len = 0;
 }
 
 /**
- * @brief Resets the provided CBuild_String to empty state
+ * @brief Resets the provided CBuild_String to empty state, the buffer is kept for reuse
  *
  * @param str The CBuilder_String pointer to the String
  */
 void CBuild_String_reset(CBuild_String *str)
 {
-    CBuild_String_deinit(str);
-    *str = CBuild_String_init("");
+    if (str->buf_len == 0)
+    {
+        *str = CBuild_String_init("");
+        return;
+    }
+
+    str->len = 0;
+    str->str[0] = '\0';
 }
 
 /**
@@ -141,13 +271,9 @@ void CBuild_String_reset(CBuild_String *str)
  */
 CBuild_String CBuild_String_copy(CBuild_String *str)
 {
-    CBuild_String newStr;
-    newStr.str = (char *)malloc(str->buf_len); // assign new memory on heap
-    newStr.buf_len = str->buf_len;     // copy the buf_len and len
-    newStr.len = str->len;
-
-    memcpy(newStr.str, str->str, str->buf_len); // actually copy the string
-    return newStr;
+    CBuild_String newStr = {NULL, 0, 0};
+    CBuild_String_reserve(&newStr, str->buf_len > str->len ? str->buf_len : str->len + 1); // keep the spare capacity
+    return *CBuild_String_append(&newStr, str->str, str->len);
 }
 
 /**
@@ -159,27 +285,7 @@ CBuild_String CBuild_String_copy(CBuild_String *str)
  */
 CBuild_String *CBuild_String_concat(CBuild_String *str1, CBuild_String *str2)
 {
-    int max_len = str1->len + str2->len + 2;
-    if (str1->buf_len < max_len) // not enough size, first allocate memory for concat [+2 for \0 chars]
-    {
-        int chunk_count = max_len / CBUILDER_BUF_CHUNK;
-        if (max_len % CBUILDER_BUF_CHUNK) // allocate extra chunk for spill
-        {
-            chunk_count++;
-        }
-
-        str1->buf_len = CBUILDER_BUF_CHUNK * chunk_count; // set new buf_len
-        char *newMem = (char *)malloc(str1->buf_len);
-        memcpy(newMem, str1->str, str1->len + 1);
-        free(str1->str); // delete the orginal and assign new
-        str1->str = newMem;
-    }
-
-    memcpy((str1->str + str1->len), str2->str, str2->len + 1); // assumes str1 has enough space
-
-    str1->len += str2->len; // assign the new len
-
-    return str1; // return the str1 reference
+    return CBuild_String_append(str1, str2->str, str2->len);
 }
 
 /**
@@ -191,28 +297,7 @@ CBuild_String *CBuild_String_concat(CBuild_String *str1, CBuild_String *str2)
  */
 CBuild_String *CBuild_String_concatCStr(CBuild_String *str1, const char *str2)
 {
-    int len2 = strlen(str2);
-    int max_len = str1->len + len2;
-    if (str1->buf_len < max_len) // not enough size, first allocate memory for concat [+2 for \0 chars]
-    {
-        int chunk_count = max_len / CBUILDER_BUF_CHUNK;
-        if (max_len % CBUILDER_BUF_CHUNK) // allocate extra chunk for spill
-        {
-            chunk_count++;
-        }
-
-        str1->buf_len = CBUILDER_BUF_CHUNK * chunk_count; // set new buf_len
-        char *newMem = (char *)malloc(str1->buf_len);
-        memcpy(newMem, str1->str, str1->len);
-        free(str1->str); // delete the orginal and assign new
-        str1->str = newMem;
-    }
-
-    memcpy((str1->str + str1->len), str2, len2 + 1); // assumes str1 has enough space
-
-    str1->len += len2; // assign the new length
-
-    return str1; // return the str1 reference
+    return CBuild_String_append(str1, str2, strlen(str2));
 }
 
 /**
@@ -226,36 +311,7 @@ CBuild_String *CBuild_String_concatCStr(CBuild_String *str1, const char *str2)
  */
 CBuild_String *CBuild_String_concatN(CBuild_String *str1, CBuild_String *str2, int count)
 {
-    int max_len = str1->len + str2->len + 2;
-    if (str1->buf_len < max_len) // not enough size, first allocate memory for concat [+2 for \0 chars]
-    {
-        int chunk_count = max_len / CBUILDER_BUF_CHUNK;
-        if (max_len % CBUILDER_BUF_CHUNK) // allocate extra chunk for spill
-        {
-            chunk_count++;
-        }
-
-        str1->buf_len = CBUILDER_BUF_CHUNK * chunk_count; // set new buf_len
-        char *newMem = (char *)malloc(str1->buf_len);
-        memcpy(newMem, str1->str, str1->len + 1);
-        free(str1->str); // delete the orginal and assign new
-        str1->str = newMem;
-    }
-
-    if (count < str2->len)
-    {
-        memcpy((str1->str + str1->len), str2->str, count); // assumes str1 has enough space
-        *(str1->str + str1->len + count + 1) = '\0'; // make sure it is null terminated
-        str1->len += count; // assign the new len
-    }
-    else
-    {
-        memcpy((str1->str + str1->len), str2->str, str2->len); // assumes str1 has enough space
-        *(str1->str + str1->len + str2->len + 1) = '\0'; // make sure it is null terminated
-        str1->len += str2->len; // assign the new len
-    }
-
-    return str1; // return the str1 reference
+    return CBuild_String_append(str1, str2->str, count < str2->len ? count : str2->len);
 }
 
 /**
@@ -269,37 +325,57 @@ CBuild_String *CBuild_String_concatN(CBuild_String *str1, CBuild_String *str2, i
  */
 CBuild_String *CBuild_String_concatCStrN(CBuild_String *str1, char *str2, int count)
 {
-    int len2 = strlen(str2);
-    int max_len = str1->len + len2;
-    if (str1->buf_len < max_len) // not enough size, first allocate memory for concat [+2 for \0 chars]
-    {
-        int chunk_count = max_len / CBUILDER_BUF_CHUNK;
-        if (max_len % CBUILDER_BUF_CHUNK) // allocate extra chunk for spill
-        {
-            chunk_count++;
-        }
+    const char *end = (const char *)memchr(str2, '\0', count); // stop at the end of str2 without reading past count
+    return CBuild_String_append(str1, str2, end ? end - str2 : count);
+}
 
-        str1->buf_len = CBUILDER_BUF_CHUNK * chunk_count; // set new buf_len
-        char *newMem = (char *)malloc(str1->buf_len);
-        memcpy(newMem, str1->str, str1->len);
-        free(str1->str); // delete the orginal and assign new
-        str1->str = newMem;
-    }
+// 64x64 bit multiply folded back to 64 bits, the mixing step of CBuild_hash
+uint64_t CBuild_hashMum(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    return ((ll & 0xffffffff) | (mid << 32)) ^ (hh + (hl >> 32) + (lh >> 32) + (mid >> 32));
+#endif
+}
 
-    if (count < len2)
-    {
-        memcpy((str1->str + str1->len), str2, count); // assumes str1 has enough space
-        *(str1->str + str1->len + count + 1) = '\0'; // make sure it is null terminated
-        str1->len += count; // assign the new len
-    }
-    else
+/**
+ * @brief Fast non cryptographic 64 bit hash (wyhash style multiply-fold) of a block of memory, consumes
+ *        16 bytes per step and is suitable for hash tables and content fingerprints
+ *
+ * @param data The memory to hash
+ * @param len The number of bytes to hash
+ * @param seed The seed, different seeds give unrelated hashes, pass a previous hash to chain blocks
+ * @return uint64_t The hash of the memory
+ */
+uint64_t CBuild_hash(const void *data, size_t len, uint64_t seed)
+{
+    const uint64_t p0 = 0xa0761d6478bd642full, p1 = 0xe7037ed1a0b428dbull, p2 = 0x8ebc6af09c88c6e3ull;
+    const unsigned char *ptr = (const unsigned char *)data;
+    uint64_t h = seed ^ p0;
+    size_t remaining = len;
+    uint64_t a, b;
+
+    while (remaining > 16)
     {
-        memcpy((str1->str + str1->len), str2, len2); // assumes str1 has enough space
-        *(str1->str + str1->len + len2 + 1) = '\0'; // make sure it is null terminated
-        str1->len += len2; // assign the new len
+        memcpy(&a, ptr, 8);
+        memcpy(&b, ptr + 8, 8);
+        h = CBuild_hashMum(a ^ p1, b ^ h);
+        ptr += 16;
+        remaining -= 16;
     }
 
-    return str1; // return the str1 reference
+    unsigned char tail[16] = {0};
+    memcpy(tail, ptr, remaining);
+    memcpy(&a, tail, 8);
+    memcpy(&b, tail + 8, 8);
+    h = CBuild_hashMum(a ^ p1, b ^ h);
+
+    return CBuild_hashMum(h ^ p2, (uint64_t)len ^ p1);
 }
 
 inline int isDelim(char ch, char *delim)
@@ -317,6 +393,185 @@ inline int isDelim(char ch, char *delim)
     return 0;
 }
 
+#define CBUILD_DELIMSET_SIMD (8) // delimiter sets upto this size are scanned 16/32 bytes at a time
+
+typedef struct
+{
+    uint64_t bits[4];                 // one bit per byte value, set for the delimiters
+    char chars[CBUILD_DELIMSET_SIMD]; // the delimiters, for the vector compares
+    int count;                        // number of chars, 0 if the set is too large for the vector path
+} CBuild_DelimSet;
+
+/**
+ * @brief Builds the lookup table of a delimiter set once, so it can be reused for every token with
+ *        CBuild_String_tokenizerSet
+ *
+ * @param set The CBuild_DelimSet * to fill
+ * @param delim The \0 terminated string where each character is a delimeter
+ */
+void CBuild_DelimSet_init(CBuild_DelimSet *set, const char *delim)
+{
+    memset(set, 0, sizeof(CBuild_DelimSet));
+
+    int count = 0;
+    for (const unsigned char *ch = (const unsigned char *)delim; *ch != '\0'; ch++)
+    {
+        if (set->bits[*ch >> 6] & (1ull << (*ch & 63))) // duplicate
+        {
+            continue;
+        }
+
+        set->bits[*ch >> 6] |= 1ull << (*ch & 63);
+        if (count < CBUILD_DELIMSET_SIMD)
+        {
+            set->chars[count] = (char)*ch;
+        }
+        count++;
+    }
+
+    set->count = count <= CBUILD_DELIMSET_SIMD ? count : 0;
+}
+
+/**
+ * @brief Checks if ch is one of the delimiters of set, a single table lookup
+ *
+ * @param set The CBuild_DelimSet * to check against
+ * @param ch The character to check
+ * @return int 1 if ch is a delimiter, 0 if not
+ */
+int CBuild_DelimSet_has(const CBuild_DelimSet *set, char ch)
+{
+    unsigned char uch = (unsigned char)ch;
+    return (set->bits[uch >> 6] >> (uch & 63)) & 1;
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// index of the lowest set bit, mask must not be 0
+int CBuild_ctz32(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/**
+ * @brief Finds the first character in [ptr, end) that ends a token (a delimiter or \0), or with findToken
+ *        the first one that starts a token (not a delimiter, \0 included), 16 or 32 bytes are compared at a time
+ *        with SSE2/AVX2 when available and the set is small, else the lookup table is used per byte
+ *
+ * @param set The CBuild_DelimSet * to scan with
+ * @param ptr The first character to check
+ * @param end The end of the memory to scan, never read
+ * @param findToken 0 to find the end of a token, 1 to skip the delimiters before one
+ * @return const char* The found character, end if there is none
+ */
+const char *CBuild_DelimSet_scan(const CBuild_DelimSet *set, const char *ptr, const char *end, int findToken)
+{
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    if (set->count)
+    {
+        // in both modes a \0 stops the scan, like the end of a c string
+        uint32_t flip = findToken ? 0xffffffffu : 0;
+#ifdef __AVX2__
+        __m256i wide[CBUILD_DELIMSET_SIMD];
+        for (int i = 0; i < set->count; i++)
+        {
+            wide[i] = _mm256_set1_epi8(set->chars[i]);
+        }
+
+        while (end - ptr >= 32)
+        {
+            __m256i block = _mm256_loadu_si256((const __m256i *)ptr);
+            __m256i hits = _mm256_setzero_si256();
+            for (int i = 0; i < set->count; i++)
+            {
+                hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, wide[i]));
+            }
+
+            uint32_t nul = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_setzero_si256()));
+            uint32_t mask = ((uint32_t)_mm256_movemask_epi8(hits) ^ flip) | nul;
+            if (mask)
+            {
+                return ptr + CBuild_ctz32(mask);
+            }
+            ptr += 32;
+        }
+#endif
+        __m128i narrow[CBUILD_DELIMSET_SIMD];
+        for (int i = 0; i < set->count; i++)
+        {
+            narrow[i] = _mm_set1_epi8(set->chars[i]);
+        }
+
+        while (end - ptr >= 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *)ptr);
+            __m128i hits = _mm_setzero_si128();
+            for (int i = 0; i < set->count; i++)
+            {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, narrow[i]));
+            }
+
+            uint32_t nul = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_setzero_si128()));
+            uint32_t mask = (((uint32_t)_mm_movemask_epi8(hits) ^ flip) & 0xffff) | nul;
+            if (mask)
+            {
+                return ptr + CBuild_ctz32(mask);
+            }
+            ptr += 16;
+        }
+    }
+#endif
+
+    while (ptr < end && *ptr != '\0' && CBuild_DelimSet_has(set, *ptr) == findToken)
+    {
+        ptr++;
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief Same as CBuild_String_tokenizer, but with a delimiter set built once by CBuild_DelimSet_init,
+ *        for splitting large listings, depfiles and response files
+ *
+ * @param original The original CBuild_String * to read from, must be passed each call, and must not be changed during calls
+ * @param prevToken The previous token read from the tokenizer, must be set to {NULL, 0, 0} initially
+ * @param set The CBuild_DelimSet * of the delimiters
+ */
+void CBuild_String_tokenizerSet(CBuild_String *original, CBuild_String *prevToken, const CBuild_DelimSet *set)
+{
+    const char *end = original->str + original->len;
+    if (prevToken->str == NULL) // first time tokenize
+    {
+        prevToken->str = original->str;
+        prevToken->len = 0;
+        prevToken->buf_len = 0; // assign the buffer length as 0 this proves that this string is a container string
+    }
+    else if (prevToken->str + prevToken->len < end)
+    {
+        prevToken->str += prevToken->len + 1; // skip the delimeter that ended the previous token
+    }
+    else
+    {
+        prevToken->str += prevToken->len; // the previous token ended the string, stay on the \0
+    }
+
+    char *ptr = (char *)CBuild_DelimSet_scan(set, prevToken->str, end, 1);
+    prevToken->str = ptr; // assign the new pointer location to tokenize from
+    prevToken->len = CBuild_DelimSet_scan(set, ptr, end, 0) - ptr;
+}
+
 /**
  * @brief Tokenizes an instance of CBuild_String with the delimeters from char *delim string
  *
@@ -328,32 +583,490 @@ inline int isDelim(char ch, char *delim)
  */
 void CBuild_String_tokenizer(CBuild_String *original, CBuild_String *prevToken, const char *delim)
 {
-    if (prevToken->str == NULL) // first time tokenize
+    CBuild_DelimSet set;
+    CBuild_DelimSet_init(&set, delim);
+    CBuild_String_tokenizerSet(original, prevToken, &set);
+}
+
+typedef struct
+{
+    const char *str; // first character, not \0 terminated in general
+    int len;         // number of characters
+} CBuild_StrView;
+
+/**
+ * @brief Makes a non owning view of a \0 terminated string
+ *
+ * @param str The string to view, must outlive the view
+ * @return CBuild_StrView The view of the whole string
+ */
+CBuild_StrView CBuild_StrView_fromCStr(const char *str)
+{
+    return (CBuild_StrView){str, (int)strlen(str)};
+}
+
+/**
+ * @brief Makes a non owning view of a CBuild_String, any growth of the string invalidates the view
+ *
+ * @param str The CBuild_String * to view
+ * @return CBuild_StrView The view of the whole string
+ */
+CBuild_StrView CBuild_StrView_fromString(const CBuild_String *str)
+{
+    return (CBuild_StrView){str->str, str->len};
+}
+
+/**
+ * @brief Compares two views in the same way as strcmp, a view that is a prefix of the other orders first
+ *
+ * @param view1 The first CBuild_StrView
+ * @param view2 The second CBuild_StrView
+ * @return int <0, 0 or >0 if view1 orders before, equal to or after view2
+ */
+int CBuild_StrView_compare(CBuild_StrView view1, CBuild_StrView view2)
+{
+    int len = view1.len < view2.len ? view1.len : view2.len;
+    int cmp = len ? memcmp(view1.str, view2.str, len) : 0;
+    if (cmp)
     {
-        prevToken->str = original->str;
-        prevToken->len = 0;
-        prevToken->buf_len = 0; // assign the buffer length as 0 this proves that this string is a container string
+        return cmp;
     }
-    else
+
+    return (view1.len > view2.len) - (view1.len < view2.len);
+}
+
+/**
+ * @brief Checks if two views hold the same characters
+ *
+ * @param view1 The first CBuild_StrView
+ * @param view2 The second CBuild_StrView
+ * @return int 1 if equal, 0 if not
+ */
+int CBuild_StrView_equals(CBuild_StrView view1, CBuild_StrView view2)
+{
+    return view1.len == view2.len && (view1.len == 0 || memcmp(view1.str, view2.str, view1.len) == 0);
+}
+
+/**
+ * @brief Initialises a heap CBuild_String with a copy of the viewed characters, which must be freed with
+ *        CBuild_String_deinit
+ *
+ * @param view The CBuild_StrView to copy
+ * @return CBuild_String The new CBuild_String
+ */
+CBuild_String CBuild_String_initView(CBuild_StrView view)
+{
+    CBuild_String str = {NULL, 0, 0};
+    CBuild_String_reserve(&str, view.len + 1);
+    return *CBuild_String_append(&str, view.str, view.len);
+}
+
+/**
+ * @brief Concatenates the viewed characters to str, without an intermediate copy
+ *
+ * @param str The CBuild_String * to append to
+ * @param view The CBuild_StrView to append
+ * @return CBuild_String* The reference to str
+ */
+CBuild_String *CBuild_String_concatView(CBuild_String *str, CBuild_StrView view)
+{
+    return CBuild_String_append(str, view.str, view.len);
+}
+
+/**
+ * @brief Appends a path component to str, with a '/' in between unless str is empty or already ends with
+ *        a separator, for example "build" + "main.o" gives "build/main.o"
+ *
+ * @param str The CBuild_String * holding the path to append to
+ * @param view The CBuild_StrView of the component to append
+ * @return CBuild_String* The reference to str
+ */
+CBuild_String *CBuild_String_joinPathView(CBuild_String *str, CBuild_StrView view)
+{
+    if (str->len && str->str[str->len - 1] != '/' && str->str[str->len - 1] != '\\')
+    {
+        CBuild_String_append(str, "/", 1);
+    }
+
+    return CBuild_String_append(str, view.str, view.len);
+}
+
+/**
+ * @brief Same as CBuild_String_joinPathView for a \0 terminated component
+ *
+ * @param str The CBuild_String * holding the path to append to
+ * @param component The \0 terminated component to append
+ * @return CBuild_String* The reference to str
+ */
+CBuild_String *CBuild_String_joinPath(CBuild_String *str, const char *component)
+{
+    return CBuild_String_joinPathView(str, CBuild_StrView_fromCStr(component));
+}
+
+#define CBUILD_VIEW(literal) ((CBuild_StrView){literal, (int)sizeof(literal) - 1}) // view of a string literal
+
+#define CBUILD_CMD_QUOTE 1 // quote the arguments that need it for the system shell
+
+// allocates a string of exactly len bytes (plus \0) for the builders below, which fill it in one pass
+CBuild_String CBuild_String_sized(int len)
+{
+    CBuild_String str = {NULL, 0, 0};
+    CBuild_String_reserve(&str, len + 1);
+    str.len = len;
+    str.str[len] = '\0';
+    return str;
+}
+
+// 1 if a path component needs a '/' before the next one
+int CBuild_String_needsSeparator(const char *path, int len)
+{
+    return len && path[len - 1] != '/' && path[len - 1] != '\\';
+}
+
+/**
+ * @brief Concatenates all views into a new CBuild_String, the total length is computed first so there is
+ *        exactly one allocation, for example {buildDir, name, CBUILD_VIEW(".o")}
+ *
+ * @param parts The array of CBuild_StrView to concatenate
+ * @param count The number of views in parts
+ * @return CBuild_String The concatenation, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_joinViews(const CBuild_StrView *parts, int count)
+{
+    int len = 0;
+    for (int i = 0; i < count; i++)
     {
-        prevToken->str += prevToken->len + 1; // update to new possible token location
+        len += parts[i].len;
     }
 
-    char *ptr = prevToken->str;
-    while (strchr(delim, *ptr) != NULL && *ptr != '\0') // make sure ptr points to a valid string loc
+    CBuild_String str = CBuild_String_sized(len);
+    char *ptr = str.str;
+    for (int i = 0; i < count; i++)
     {
-        ptr++;
+        memcpy(ptr, parts[i].str, parts[i].len);
+        ptr += parts[i].len;
     }
 
-    prevToken->str = ptr; // assign the new pointer location to tokenize from
+    return str;
+}
+
+/**
+ * @brief Joins path components like CBuild_String_joinPathView into a new CBuild_String with one allocation
+ *
+ * @param parts The array of CBuild_StrView path components, empty components are skipped
+ * @param count The number of views in parts
+ * @return CBuild_String The joined path, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_pathViews(const CBuild_StrView *parts, int count)
+{
     int len = 0;
-    while (strchr(delim, *ptr) == NULL && ptr - original->str < original->len)
+    const char *prev = NULL;
+    int prevLen = 0;
+    for (int i = 0; i < count; i++)
     {
-        len++;
-        ptr++;
+        if (!parts[i].len)
+        {
+            continue;
+        }
+
+        len += parts[i].len + CBuild_String_needsSeparator(prev, prevLen);
+        prev = parts[i].str;
+        prevLen = parts[i].len;
+    }
+
+    CBuild_String str = CBuild_String_sized(len);
+    char *ptr = str.str;
+    for (int i = 0; i < count; i++)
+    {
+        if (!parts[i].len)
+        {
+            continue;
+        }
+
+        if (CBuild_String_needsSeparator(str.str, ptr - str.str))
+        {
+            *ptr++ = '/';
+        }
+        memcpy(ptr, parts[i].str, parts[i].len);
+        ptr += parts[i].len;
+    }
+
+    return str;
+}
+
+/**
+ * @brief Joins the NULL terminated list of path components with one allocation @n
+ *        Example: CBuild_String_path("build", "obj", "main.o", NULL) gives "build/obj/main.o"
+ *
+ * @param first The first component, the list must end with NULL
+ * @return CBuild_String The joined path, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_path(const char *first, ...)
+{
+    va_list args;
+    int count = 0;
+
+    va_start(args, first);
+    for (const char *part = first; part != NULL; part = va_arg(args, const char *))
+    {
+        count++;
+    }
+    va_end(args);
+
+    CBuild_StrView parts[count ? count : 1];
+    va_start(args, first);
+    const char *part = first;
+    for (int i = 0; i < count; i++, part = va_arg(args, const char *))
+    {
+        parts[i] = CBuild_StrView_fromCStr(part);
+    }
+    va_end(args);
+
+    return CBuild_String_pathViews(parts, count);
+}
+
+// safe characters are never quoted, so the usual compiler arguments stay readable
+int CBuild_String_isShellSafe(char ch)
+{
+    return isalnum((unsigned char)ch) || strchr("_-+=%@:,./", ch) != NULL;
+}
+
+// length of arg after quoting with CBUILD_CMD_QUOTE
+int CBuild_String_quotedLen(const char *arg, int len)
+{
+    int needsQuotes = len == 0;
+    for (int i = 0; i < len && !needsQuotes; i++)
+    {
+        needsQuotes = !CBuild_String_isShellSafe(arg[i]);
+    }
+
+    if (!needsQuotes)
+    {
+        return len;
+    }
+
+    int quotedLen = len + 2;
+#ifdef _WIN32
+    int slashes = 0; // backslashes are only special before a '"', or before the closing quote
+    for (int i = 0; i < len; i++)
+    {
+        if (arg[i] == '\\')
+        {
+            slashes++;
+            continue;
+        }
+
+        if (arg[i] == '"')
+        {
+            quotedLen += slashes + 1;
+        }
+        slashes = 0;
+    }
+    quotedLen += slashes;
+#else
+    for (int i = 0; i < len; i++)
+    {
+        if (arg[i] == '\'')
+        {
+            quotedLen += 3; // ' becomes '\''
+        }
+    }
+#endif
+
+    return quotedLen;
+}
+
+// writes arg quoted for the system shell to dst, returns the end of the written characters
+char *CBuild_String_writeQuoted(char *dst, const char *arg, int len)
+{
+    if (CBuild_String_quotedLen(arg, len) == len) // nothing to quote
+    {
+        memcpy(dst, arg, len);
+        return dst + len;
+    }
+
+#ifdef _WIN32
+    *dst++ = '"';
+    int slashes = 0;
+    for (int i = 0; i < len; i++)
+    {
+        if (arg[i] == '\\')
+        {
+            slashes++;
+        }
+        else
+        {
+            if (arg[i] == '"')
+            {
+                memset(dst, '\\', slashes + 1); // double the backslashes and escape the quote
+                dst += slashes + 1;
+            }
+            slashes = 0;
+        }
+        *dst++ = arg[i];
+    }
+    memset(dst, '\\', slashes); // the closing quote must not be escaped
+    dst += slashes;
+    *dst++ = '"';
+#else
+    *dst++ = '\'';
+    for (int i = 0; i < len; i++)
+    {
+        if (arg[i] == '\'')
+        {
+            memcpy(dst, "'\\''", 4);
+            dst += 4;
+        }
+        else
+        {
+            *dst++ = arg[i];
+        }
+    }
+    *dst++ = '\'';
+#endif
+
+    return dst;
+}
+
+/**
+ * @brief Joins the views of a command line with spaces into a new CBuild_String with one allocation
+ *
+ * @param args The array of CBuild_StrView arguments
+ * @param count The number of views in args
+ * @param flags CBUILD_CMD_QUOTE to quote the arguments holding spaces or shell characters (POSIX sh rules,
+ *              or the Windows command line rules on Windows), 0 to join them as they are
+ * @return CBuild_String The command line, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_commandViews(const CBuild_StrView *args, int count, int flags)
+{
+    int len = count ? count - 1 : 0; // the spaces
+    for (int i = 0; i < count; i++)
+    {
+        len += (flags & CBUILD_CMD_QUOTE) ? CBuild_String_quotedLen(args[i].str, args[i].len) : args[i].len;
+    }
+
+    CBuild_String str = CBuild_String_sized(len);
+    char *ptr = str.str;
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+        {
+            *ptr++ = ' ';
+        }
+
+        if (flags & CBUILD_CMD_QUOTE)
+        {
+            ptr = CBuild_String_writeQuoted(ptr, args[i].str, args[i].len);
+        }
+        else
+        {
+            memcpy(ptr, args[i].str, args[i].len);
+            ptr += args[i].len;
+        }
+    }
+
+    return str;
+}
+
+/**
+ * @brief Joins a NULL terminated argument vector into a command line, see CBuild_String_commandViews
+ *
+ * @param argv The NULL terminated argument vector
+ * @param flags CBUILD_CMD_QUOTE or 0
+ * @return CBuild_String The command line, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_commandArgv(char *const argv[], int flags)
+{
+    int count = 0;
+    while (argv[count] != NULL)
+    {
+        count++;
+    }
+
+    CBuild_StrView args[count ? count : 1];
+    for (int i = 0; i < count; i++)
+    {
+        args[i] = CBuild_StrView_fromCStr(argv[i]);
+    }
+
+    return CBuild_String_commandViews(args, count, flags);
+}
+
+/**
+ * @brief Joins the NULL terminated list of arguments into a command line, see CBuild_String_commandViews @n
+ *        Example: CBuild_String_command(CBUILD_CMD_QUOTE, "g++", "-c", src, "-o", out, NULL)
+ *
+ * @param flags CBUILD_CMD_QUOTE or 0
+ * @param first The first argument, the list must end with NULL
+ * @return CBuild_String The command line, must be freed with CBuild_String_deinit
+ */
+CBuild_String CBuild_String_command(int flags, const char *first, ...)
+{
+    va_list args;
+    int count = 0;
+
+    va_start(args, first);
+    for (const char *arg = first; arg != NULL; arg = va_arg(args, const char *))
+    {
+        count++;
+    }
+    va_end(args);
+
+    CBuild_StrView views[count ? count : 1];
+    va_start(args, first);
+    const char *arg = first;
+    for (int i = 0; i < count; i++, arg = va_arg(args, const char *))
+    {
+        views[i] = CBuild_StrView_fromCStr(arg);
+    }
+    va_end(args);
+
+    return CBuild_String_commandViews(views, count, flags);
+}
+
+typedef struct
+{
+    const char *ptr; // start of the unread text
+    const char *end; // end of the text
+    CBuild_DelimSet set;
+} CBuild_Split;
+
+/**
+ * @brief Initialises an iterator over the tokens of text, the tokens are views into text, so nothing
+ *        is copied or allocated and nothing needs to be freed
+ *
+ * @param split The CBuild_Split * to initialise
+ * @param text The CBuild_StrView to split, must outlive the iterator and its tokens
+ * @param delim The \0 terminated string where each character is a delimeter, runs of delimeters are skipped
+ */
+void CBuild_Split_init(CBuild_Split *split, CBuild_StrView text, const char *delim)
+{
+    split->ptr = text.str;
+    split->end = text.str + text.len;
+    CBuild_DelimSet_init(&split->set, delim);
+}
+
+/**
+ * @brief Reads the next token of the split, a \0 in the text ends it like in CBuild_String_tokenizer
+ *
+ * @param split The CBuild_Split * to read from
+ * @param token The CBuild_StrView * to store the token in
+ * @return int 1 if a token was read, 0 at the end of the text
+ */
+int CBuild_Split_next(CBuild_Split *split, CBuild_StrView *token)
+{
+    const char *ptr = CBuild_DelimSet_scan(&split->set, split->ptr, split->end, 1);
+    if (ptr == split->end || *ptr == '\0')
+    {
+        split->ptr = split->end;
+        return 0;
     }
 
-    prevToken->len = len;
+    const char *tokenEnd = CBuild_DelimSet_scan(&split->set, ptr, split->end, 0);
+    token->str = ptr;
+    token->len = tokenEnd - ptr;
+    split->ptr = tokenEnd;
+    return 1;
 }
 
 #endif // INCLUDED_CBUILDER_STRING
\ No newline at end of file
@@ -0,0 +1,362 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#ifndef INCLUDED_CBUILDER_TOOLCHAIN
+#define INCLUDED_CBUILDER_TOOLCHAIN
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cbuilder_arena.h"
+#include "cbuilder_list.h"
+#include "cbuilder_graph.h"
+
+// languages of the compile rules
+#define CBUILD_LANG_C 0
+#define CBUILD_LANG_CXX 1
+#define CBUILD_LANG_ASM 2
+#define CBUILD_LANG_COUNT 3
+#define CBUILD_LANG_ALL -1 // a flag for every language
+
+// rules generated by a toolchain
+#define CBUILD_RULE_C_OBJECT 0
+#define CBUILD_RULE_CXX_OBJECT 1
+#define CBUILD_RULE_ASM_OBJECT 2
+#define CBUILD_RULE_STATIC_LIB 3
+#define CBUILD_RULE_EXECUTABLE 4
+#define CBUILD_RULE_SHARED_LIB 5
+#define CBUILD_RULE_COUNT 6
+
+/*
+ * A toolchain describes the compilers and the flags of a build once, its rules are ready made command templates
+ * for CBuild_Graph_add, so adding a target only fills in the paths @n
+ * The flags, include folders and defines are copied into the toolchain and are shared by all its compile rules,
+ * the rules are generated on the first CBuild_Toolchain_rule call and the toolchain can not be changed after it
+ */
+typedef struct
+{
+    const char *compilers[CBUILD_LANG_COUNT]; // compiler drivers, assembly goes through the C driver by default
+    const char *archiver;                     // static library tool, "ar" by default
+    const char *linker;                       // driver for executables and shared libraries, the C++ one by default
+
+    CBuild_Vec flags[CBUILD_LANG_COUNT]; // const char *, compile flags of every language, includes and defines
+    CBuild_Vec linkFlags;                // const char *, flags after the inputs of a link, for example -lm
+    CBuild_Arena arena;                  // copies of the flags and the generated templates
+
+    CBuild_Rule rules[CBUILD_RULE_COUNT];
+    int generated; // the rules are generated, the toolchain is frozen
+} CBuild_Toolchain;
+
+/**
+ * @brief Initialises a GNU style toolchain, gcc, g++ and ar with the optional prefix of a cross compiler, other
+ *        compatible compilers are set afterwards, for example toolchain.compilers[CBUILD_LANG_CXX] = "clang++"
+ *
+ * @param toolchain The CBuild_Toolchain * to initialise, must be freed with CBuild_Toolchain_deinit
+ * @param prefix The prefix of the tools, for example "arm-none-eabi-", NULL for the host compilers
+ */
+void CBuild_Toolchain_init(CBuild_Toolchain *toolchain, const char *prefix)
+{
+    CBuild_Arena_init(&toolchain->arena, 0);
+    for (int i = 0; i < CBUILD_LANG_COUNT; i++)
+    {
+        CBuild_Vec_init(&toolchain->flags[i], sizeof(const char *));
+    }
+    CBuild_Vec_init(&toolchain->linkFlags, sizeof(const char *));
+
+    int prefixLen = prefix ? strlen(prefix) : 0;
+    const char *tools[] = {"gcc", "g++", "ar"};
+    char *names[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int toolLen = strlen(tools[i]);
+        names[i] = (char *)CBuild_Arena_alloc(&toolchain->arena, prefixLen + toolLen + 1);
+        if (prefixLen)
+        {
+            memcpy(names[i], prefix, prefixLen);
+        }
+        memcpy(names[i] + prefixLen, tools[i], toolLen + 1);
+    }
+
+    toolchain->compilers[CBUILD_LANG_C] = names[0];
+    toolchain->compilers[CBUILD_LANG_CXX] = names[1];
+    toolchain->compilers[CBUILD_LANG_ASM] = names[0];
+    toolchain->archiver = names[2];
+    toolchain->linker = NULL;
+    toolchain->generated = 0;
+}
+
+/**
+ * @brief Frees the toolchain, its rules must not be used by a graph anymore
+ *
+ * @param toolchain The CBuild_Toolchain * to free
+ */
+void CBuild_Toolchain_deinit(CBuild_Toolchain *toolchain)
+{
+    for (int i = 0; i < CBUILD_LANG_COUNT; i++)
+    {
+        CBuild_Vec_deinit(&toolchain->flags[i]);
+    }
+    CBuild_Vec_deinit(&toolchain->linkFlags);
+    CBuild_Arena_deinit(&toolchain->arena);
+    toolchain->generated = 0;
+}
+
+// appends prefix + value, copied to the arena, to the flags of lang, -1 once the rules are generated
+int CBuild_Toolchain_push(CBuild_Toolchain *toolchain, CBuild_Vec *flags, const char *prefix, const char *value)
+{
+    if (toolchain->generated)
+    {
+        fprintf(stderr, "[CBuilder Toolchain Error] %s%s added after the rules were generated\n", prefix, value);
+        return -1;
+    }
+
+    int prefixLen = strlen(prefix);
+    int valueLen = strlen(value);
+    char *flag = (char *)CBuild_Arena_alloc(&toolchain->arena, prefixLen + valueLen + 1);
+    memcpy(flag, prefix, prefixLen);
+    memcpy(flag + prefixLen, value, valueLen + 1);
+    CBuild_Vec_push(flags, &flag);
+    return 0;
+}
+
+// adds prefix + value to one language, or to all of them with CBUILD_LANG_ALL
+int CBuild_Toolchain_pushLang(CBuild_Toolchain *toolchain, int lang, const char *prefix, const char *value)
+{
+    for (int i = 0; i < CBUILD_LANG_COUNT; i++)
+    {
+        if ((lang == CBUILD_LANG_ALL || lang == i) && CBuild_Toolchain_push(toolchain, &toolchain->flags[i], prefix, value))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Adds a compile flag, for example -O2, -Wall or -std=c++17
+ *
+ * @param toolchain The CBuild_Toolchain * to add to
+ * @param lang The CBUILD_LANG_* the flag is for, CBUILD_LANG_ALL for every language
+ * @param flag The flag, copied
+ * @return int 0 on success, -1 if the rules were already generated
+ */
+int CBuild_Toolchain_addFlag(CBuild_Toolchain *toolchain, int lang, const char *flag)
+{
+    return CBuild_Toolchain_pushLang(toolchain, lang, "", flag);
+}
+
+/**
+ * @brief Adds an include folder to every language, as -I<dir>
+ *
+ * @param toolchain The CBuild_Toolchain * to add to
+ * @param dir The folder, copied
+ * @return int 0 on success, -1 if the rules were already generated
+ */
+int CBuild_Toolchain_addInclude(CBuild_Toolchain *toolchain, const char *dir)
+{
+    return CBuild_Toolchain_pushLang(toolchain, CBUILD_LANG_ALL, "-I", dir);
+}
+
+/**
+ * @brief Adds a preprocessor define to every language, as -D<define>
+ *
+ * @param toolchain The CBuild_Toolchain * to add to
+ * @param define The define, NAME or NAME=VALUE, copied
+ * @return int 0 on success, -1 if the rules were already generated
+ */
+int CBuild_Toolchain_addDefine(CBuild_Toolchain *toolchain, const char *define)
+{
+    return CBuild_Toolchain_pushLang(toolchain, CBUILD_LANG_ALL, "-D", define);
+}
+
+/**
+ * @brief Adds a flag to the links of executables and shared libraries, placed after the inputs, for example
+ *        -lm or -L./lib
+ *
+ * @param toolchain The CBuild_Toolchain * to add to
+ * @param flag The flag, copied
+ * @return int 0 on success, -1 if the rules were already generated
+ */
+int CBuild_Toolchain_addLinkFlag(CBuild_Toolchain *toolchain, const char *flag)
+{
+    return CBuild_Toolchain_push(toolchain, &toolchain->linkFlags, "", flag);
+}
+
+// builds a NULL terminated template in the arena from head, the flags in between and tail
+const char *const *CBuild_Toolchain_template(CBuild_Toolchain *toolchain, const char *const *head, CBuild_Vec *flags,
+                                             const char *const *tail)
+{
+    int count = 1 + flags->count;
+    for (int i = 0; head[i]; i++)
+    {
+        count++;
+    }
+    for (int i = 0; tail[i]; i++)
+    {
+        count++;
+    }
+
+    const char **args = (const char **)CBuild_Arena_alloc(&toolchain->arena, count * sizeof(const char *));
+    int argc = 0;
+    for (int i = 0; head[i]; i++)
+    {
+        args[argc++] = head[i];
+    }
+    for (int i = 0; i < flags->count; i++)
+    {
+        args[argc++] = CBUILD_VEC_AT(flags, const char *, i);
+    }
+    for (int i = 0; tail[i]; i++)
+    {
+        args[argc++] = tail[i];
+    }
+    args[argc] = NULL;
+
+    return args;
+}
+
+// generates all the rule templates, once
+void CBuild_Toolchain_generate(CBuild_Toolchain *toolchain)
+{
+    const char *const compileTail[] = {"-c", "$in", "-o", "$out", "-MMD", "-MF", "$depfile", NULL};
+    const char *const preprocessTail[] = {"-E", "$in", "-o", "$out", NULL};
+    const char *names[CBUILD_LANG_COUNT] = {"CC", "CXX", "AS"};
+    for (int lang = 0; lang < CBUILD_LANG_COUNT; lang++)
+    {
+        const char *const head[] = {toolchain->compilers[lang], NULL};
+        CBuild_Rule *rule = &toolchain->rules[CBUILD_RULE_C_OBJECT + lang];
+        rule->name = names[lang];
+        rule->args = CBuild_Toolchain_template(toolchain, head, &toolchain->flags[lang], compileTail);
+        rule->preprocess = lang == CBUILD_LANG_ASM ? NULL : // plain .s sources have no preprocessor stage
+                               CBuild_Toolchain_template(toolchain, head, &toolchain->flags[lang], preprocessTail);
+        rule->kind = CBUILD_NODE_OBJECT;
+    }
+
+    CBuild_Vec noFlags;
+    CBuild_Vec_init(&noFlags, sizeof(const char *));
+    const char *linker = toolchain->linker ? toolchain->linker : toolchain->compilers[CBUILD_LANG_CXX];
+    const char *const archiveHead[] = {toolchain->archiver, "rcs", "$out", "$in", NULL};
+    const char *const linkHead[] = {linker, "$in", "-o", "$out", NULL};
+    const char *const sharedHead[] = {linker, "-shared", "$in", "-o", "$out", NULL};
+    const char *const none[] = {NULL};
+
+    toolchain->rules[CBUILD_RULE_STATIC_LIB] =
+        (CBuild_Rule){"AR", CBuild_Toolchain_template(toolchain, archiveHead, &noFlags, none), NULL, CBUILD_NODE_STATIC_LIB};
+    toolchain->rules[CBUILD_RULE_EXECUTABLE] =
+        (CBuild_Rule){"LINK", CBuild_Toolchain_template(toolchain, linkHead, &toolchain->linkFlags, none), NULL, CBUILD_NODE_EXECUTABLE};
+    toolchain->rules[CBUILD_RULE_SHARED_LIB] =
+        (CBuild_Rule){"SOLINK", CBuild_Toolchain_template(toolchain, sharedHead, &toolchain->linkFlags, none), NULL, CBUILD_NODE_SHARED_LIB};
+
+    CBuild_Vec_deinit(&noFlags);
+    toolchain->generated = 1;
+}
+
+/**
+ * @brief Returns a rule of the toolchain for CBuild_Graph_add, the first call generates all the rules @n
+ *        Note: shared libraries need objects compiled with -fPIC
+ *
+ * @param toolchain The CBuild_Toolchain * with all its flags added
+ * @param rule One of the CBUILD_RULE_*
+ * @return const CBuild_Rule* The rule, valid until CBuild_Toolchain_deinit, NULL for an unknown rule
+ */
+const CBuild_Rule *CBuild_Toolchain_rule(CBuild_Toolchain *toolchain, int rule)
+{
+    if (rule < 0 || rule >= CBUILD_RULE_COUNT)
+    {
+        fprintf(stderr, "[CBuilder Toolchain Error] Unknown rule %d\n", rule);
+        return NULL;
+    }
+    if (!toolchain->generated)
+    {
+        CBuild_Toolchain_generate(toolchain);
+    }
+
+    return &toolchain->rules[rule];
+}
+
+/**
+ * @brief Returns the language of a source file from its extension, .c is C, .s and .S are assembly and
+ *        .cpp .cc .cxx .c++ and .C are C++ @n
+ *        Note: .asm is unknown, the driver does not recognise it and would pass it to the linker without
+ *        compiling anything
+ *
+ * @param path The path of the source file
+ * @return int The CBUILD_LANG_* of the file, -1 for an unknown extension
+ */
+int CBuild_Toolchain_language(const char *path)
+{
+    const char *dot = strrchr(path, '.');
+    const char *slash = strrchr(path, '/');
+    if (!dot || (slash && dot < slash))
+    {
+        return -1;
+    }
+
+    dot++;
+    if (strcmp(dot, "c") == 0)
+    {
+        return CBUILD_LANG_C;
+    }
+    if (strcmp(dot, "s") == 0 || strcmp(dot, "S") == 0)
+    {
+        return CBUILD_LANG_ASM;
+    }
+
+    const char *cxx[] = {"cpp", "cc", "cxx", "c++", "C"};
+    for (int i = 0; i < 5; i++)
+    {
+        if (strcmp(dot, cxx[i]) == 0)
+        {
+            return CBUILD_LANG_CXX;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Adds the target compiling one source file to graph, the compile rule is picked from the extension
+ *
+ * @param toolchain The CBuild_Toolchain * to compile with
+ * @param graph The CBuild_Graph * to add the target to
+ * @param source The path of the source file
+ * @param object The path of the object file to build
+ * @return int The id of the new node, -1 on failure
+ */
+int CBuild_Toolchain_addObject(CBuild_Toolchain *toolchain, CBuild_Graph *graph, const char *source, const char *object)
+{
+    int lang = CBuild_Toolchain_language(source);
+    if (lang < 0)
+    {
+        fprintf(stderr, "[CBuilder Toolchain Error] Unknown language of %s\n", source);
+        return -1;
+    }
+
+    return CBuild_Graph_add(graph, CBuild_Toolchain_rule(toolchain, CBUILD_RULE_C_OBJECT + lang), object, &source, 1);
+}
+
+#endif // INCLUDED_CBUILDER_TOOLCHAIN
@@ -0,0 +1,259 @@
+/*
+MIT License
+
+Copyright (c) 2024 Rouvik Maji
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#ifndef INCLUDED_CBUILDER_TRACE
+#define INCLUDED_CBUILDER_TRACE
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Opt-in build tracing in the Chrome trace_event JSON format, the file opens directly in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing @n
+ * Every job of a CBuild_JobPool is a span on the track of its slot, so idle slots show up as gaps, and the
+ * internal phases (directory scan, dependency check, scheduling) are spans on the track of the build thread @n
+ * Note: the events are written from the thread driving the build, the recording functions are not thread safe
+ */
+typedef struct
+{
+    FILE *file;      // the trace being written, NULL while tracing is off
+    int64_t startNs; // CBuild_nowNs() when the trace was opened, timestamps are relative to it
+    int events;      // number of events written so far
+    int maxSlot;     // highest job slot seen, named in CBuild_Trace_close
+} CBuild_Trace;
+
+CBuild_Trace CBuild_trace = {NULL, 0, 0, -1};
+
+// track of the build thread, the job slots follow it
+#define CBUILD_TRACE_MAIN_TID 0
+
+int64_t CBuild_nowNs(); // defined by cbuilder_exec.h
+
+/**
+ * @brief Starts writing the trace to path, all the jobs and phases from now on are recorded until
+ *        CBuild_Trace_close
+ *
+ * @param path The path of the JSON file, for example ./build/trace.json
+ * @return int 0 on success, -1 if the file could not be opened
+ */
+int CBuild_Trace_open(const char *path)
+{
+    if (CBuild_trace.file)
+    {
+        fprintf(stderr, "[CBuilder Trace Error] A trace is already being written\n");
+        return -1;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "[CBuilder Trace Error] Failed to open %s for writing\n", path);
+        return -1;
+    }
+
+    CBuild_trace.file = file;
+    CBuild_trace.startNs = CBuild_nowNs();
+    CBuild_trace.events = 0;
+    CBuild_trace.maxSlot = -1;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    return 0;
+}
+
+/**
+ * @brief Returns 1 while a trace is being written, so callers can skip building the event details otherwise
+ *
+ * @return int 1 if tracing is on, 0 otherwise
+ */
+int CBuild_Trace_enabled()
+{
+    return CBuild_trace.file != NULL;
+}
+
+/**
+ * @brief Returns the start timestamp of a span, passed back to CBuild_Trace_phase or CBuild_Trace_job
+ *
+ * @return int64_t CBuild_nowNs() while tracing, 0 otherwise so the clock is not read for nothing
+ */
+int64_t CBuild_Trace_begin()
+{
+    return CBuild_trace.file ? CBuild_nowNs() : 0;
+}
+
+// writes str as a JSON string literal, quotes included
+void CBuild_Trace_writeString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const unsigned char *ptr = (const unsigned char *)str; *ptr; ptr++)
+    {
+        if (*ptr == '"' || *ptr == '\\')
+        {
+            fputc('\\', file);
+            fputc(*ptr, file);
+        }
+        else if (*ptr < 0x20)
+        {
+            fprintf(file, "\\u%04x", *ptr);
+        }
+        else
+        {
+            fputc(*ptr, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// writes the fields every event shares and leaves the object open for the args
+void CBuild_Trace_eventStart(const char *name, const char *cat, char ph, int tid, int64_t startNs)
+{
+    FILE *file = CBuild_trace.file;
+    if (CBuild_trace.events++)
+    {
+        fputs(",\n", file);
+    }
+
+    fputs("{\"name\":", file);
+    CBuild_Trace_writeString(file, name);
+    fprintf(file, ",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", cat, ph, tid,
+            (startNs - CBuild_trace.startNs) / 1e3);
+}
+
+/**
+ * @brief Records an internal phase of the build as a span on the build thread track
+ *
+ * @param name The name of the phase, for example "scan" or "dep check"
+ * @param detail What the phase worked on, for example the scanned folder or the checked output, may be NULL
+ * @param startNs The value CBuild_Trace_begin returned when the phase started
+ */
+void CBuild_Trace_phase(const char *name, const char *detail, int64_t startNs)
+{
+    if (!CBuild_trace.file)
+    {
+        return;
+    }
+
+    int64_t endNs = CBuild_nowNs();
+    CBuild_Trace_eventStart(name, "phase", 'X', CBUILD_TRACE_MAIN_TID, startNs);
+    fprintf(CBuild_trace.file, ",\"dur\":%.3f", (endNs - startNs) / 1e3);
+    if (detail)
+    {
+        fputs(",\"args\":{\"detail\":", CBuild_trace.file);
+        CBuild_Trace_writeString(CBuild_trace.file, detail);
+        fputc('}', CBuild_trace.file);
+    }
+    fputc('}', CBuild_trace.file);
+}
+
+/**
+ * @brief Records a finished job as a span on the track of the slot it ran in
+ *
+ * @param slot The slot of the CBuild_JobPool the job occupied
+ * @param name The name shown on the span, for example the output it built
+ * @param command The full command line, may be NULL
+ * @param startNs When the job was started
+ * @param status The exit status of the job
+ * @param cpuNs The user and system CPU time of the job, 0 if not measured
+ * @param maxRssKb The peak memory of the job in KiB, 0 if not measured
+ */
+void CBuild_Trace_job(int slot, const char *name, const char *command, int64_t startNs, int status, int64_t cpuNs,
+                      int64_t maxRssKb)
+{
+    if (!CBuild_trace.file)
+    {
+        return;
+    }
+
+    int64_t endNs = CBuild_nowNs();
+    CBuild_trace.maxSlot = slot > CBuild_trace.maxSlot ? slot : CBuild_trace.maxSlot;
+    CBuild_Trace_eventStart(name, "job", 'X', CBUILD_TRACE_MAIN_TID + 1 + slot, startNs);
+    fprintf(CBuild_trace.file, ",\"dur\":%.3f,\"args\":{\"exit\":%d,\"cpu_ms\":%.3f,\"max_rss_kb\":%lld",
+            (endNs - startNs) / 1e3, status, cpuNs / 1e6, (long long)maxRssKb);
+    if (command)
+    {
+        fputs(",\"command\":", CBuild_trace.file);
+        CBuild_Trace_writeString(CBuild_trace.file, command);
+    }
+    fputs("}}", CBuild_trace.file);
+}
+
+/**
+ * @brief Records the value of a counter, drawn as a graph over time, for example the number of running jobs
+ *
+ * @param name The name of the counter
+ * @param value The new value of the counter
+ */
+void CBuild_Trace_counter(const char *name, int value)
+{
+    if (!CBuild_trace.file)
+    {
+        return;
+    }
+
+    CBuild_Trace_eventStart(name, "counter", 'C', CBUILD_TRACE_MAIN_TID, CBuild_nowNs());
+    fprintf(CBuild_trace.file, ",\"args\":{\"value\":%d}}", value);
+}
+
+// names a track of the trace
+void CBuild_Trace_threadName(int tid, const char *name)
+{
+    CBuild_Trace_eventStart("thread_name", "__metadata", 'M', tid, CBuild_trace.startNs);
+    fputs(",\"args\":{\"name\":", CBuild_trace.file);
+    CBuild_Trace_writeString(CBuild_trace.file, name);
+    fputs("}}", CBuild_trace.file);
+}
+
+/**
+ * @brief Names the tracks and finishes the trace file, tracing is off afterwards
+ *
+ * @return int 0 on success, -1 if the trace could not be written completely
+ */
+int CBuild_Trace_close()
+{
+    if (!CBuild_trace.file)
+    {
+        return 0;
+    }
+
+    CBuild_Trace_threadName(CBUILD_TRACE_MAIN_TID, "cbuilder");
+    for (int slot = 0; slot <= CBuild_trace.maxSlot; slot++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "job slot %d", slot);
+        CBuild_Trace_threadName(CBUILD_TRACE_MAIN_TID + 1 + slot, name);
+    }
+
+    fputs("\n]}\n", CBuild_trace.file);
+    int failed = ferror(CBuild_trace.file) | fclose(CBuild_trace.file);
+    CBuild_trace.file = NULL;
+    if (failed)
+    {
+        fprintf(stderr, "[CBuilder Trace Error] Failed to write the trace\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+#endif // INCLUDED_CBUILDER_TRACE
@@ -4,55 +4,106 @@
 
 int main()
 {
-    CBuild_String buildDir = CBuild_String_init("./sample/build/");
-
-    CBuild_String dir = CBuild_Fs_dir("./sample/code", "/*.*", CBUILD_FS_DIRMODE_FOLDERS, ":");
-
-    CBuild_String depFolder = {NULL, 0, 0};
-    CBuild_String_tokenizer(&dir, &depFolder, ":");
-    while (depFolder.str[0] != '\0')
+    const char *tracePath = getenv("CBUILD_TRACE"); // optional, a Chrome trace of the build for Perfetto
+    if (tracePath)
     {
-        CBuild_String srcPath = CBuild_String_init("./sample/code/");
-        CBuild_String_concatN(&srcPath, &depFolder, depFolder.len);
-        CBuild_String_concatCStr(&srcPath, "/");
-        CBuild_String_concatN(&srcPath, &depFolder, depFolder.len);
+        CBuild_Trace_open(tracePath);
+    }
 
-        CBuild_String outPath = CBuild_String_copy(&buildDir);
-        CBuild_String_concatN(&outPath, &depFolder, depFolder.len);
-        CBuild_String_concatCStr(&outPath, ".o");
+    CBuild_Toolchain toolchain; // gcc, g++ and ar, flags would be added here once for every target
+    CBuild_Toolchain_init(&toolchain, NULL);
 
-        CBuild_String_concatCStr(&srcPath, ".cpp");
+    CBuild_Graph graph;
+    CBuild_Graph_init(&graph);
 
-        CBuild_String command = CBuild_String_init("g++ ");
-        CBuild_String_concat(&command, &srcPath);
-        CBuild_String_concatCStr(&command, " -c -o ");
-        CBuild_String_concat(&command, &outPath);
+    CBuild_Vec folders; // CBuild_String names of the folders in ./sample/code
+    CBuild_Vec_init(&folders, sizeof(CBuild_String));
+    CBuild_Fs_dirVec(NULL, "./sample/code", "/*.*", CBUILD_FS_DIRMODE_FOLDERS, &folders);
 
-        printf("SRC: %s\nOUT: %s\nCMD: %s\n", srcPath.str, outPath.str, command.str);
+    CBuild_Vec linkInputs; // const char * paths owned by the graph
+    CBuild_Vec_init(&linkInputs, sizeof(const char *));
+    const char *mainSource = "./sample/main.cpp";
+    CBuild_Vec_push(&linkInputs, &mainSource);
 
-        if (system(command.str))
+    for (int i = 0; i < folders.count; i++) // one object per folder, ./sample/code/<name>/<name>.cpp
+    {
+        CBuild_StrView name = CBuild_StrView_fromString(&CBUILD_VEC_AT(&folders, CBuild_String, i));
+        CBuild_String srcPath = CBuild_String_joinViews(
+            (CBuild_StrView[]){CBUILD_VIEW("./sample/code/"), name, CBUILD_VIEW("/"), name, CBUILD_VIEW(".cpp")}, 5);
+        CBuild_String outPath = CBuild_String_joinViews((CBuild_StrView[]){CBUILD_VIEW("./sample/build/"), name, CBUILD_VIEW(".o")}, 3);
+
+        int node = CBuild_Toolchain_addObject(&toolchain, &graph, srcPath.str, outPath.str);
+        if (node >= 0)
         {
-            fprintf(stderr, "Failed to compile: %s\n", srcPath.str);
+            const char *objPath = CBuild_Graph_output(&graph, node);
+            CBuild_Vec_push(&linkInputs, &objPath);
         }
 
         CBuild_String_deinit(&srcPath);
         CBuild_String_deinit(&outPath);
-        CBuild_String_deinit(&command);
+    }
+    CBuild_Fs_freeNames(&folders);
+
+    // the link waits only for its own objects
+    CBuild_Graph_add(&graph, CBuild_Toolchain_rule(&toolchain, CBUILD_RULE_EXECUTABLE), "./sample/build/main.exe",
+                     (const char *const *)linkInputs.data, linkInputs.count);
+    CBuild_Vec_deinit(&linkInputs);
 
-        CBuild_String_tokenizer(&dir, &depFolder, ":");
+    CBuild_JobPool pool;
+    CBuild_JobPool_init(&pool, 0); // one job per processor
+
+    // under make the -j limit of make is shared, otherwise sub-makes started by the rules share ours
+    CBuild_Jobserver jobserver;
+    int useJobserver = !CBuild_Jobserver_connect(&jobserver) || !CBuild_Jobserver_create(&jobserver, pool.maxJobs, NULL);
+    if (useJobserver)
+    {
+        CBuild_JobPool_setJobserver(&pool, &jobserver);
     }
 
-    CBuild_String_deinit(&dir);
+    CBuild_Db db;
+    CBuild_Db_open(&db, "./sample/build/.cbuild_db");
+
+    CBuild_Cache cache; // optional, enabled by setting CBUILD_CACHE_DIR
+    const char *cacheDir = getenv("CBUILD_CACHE_DIR");
+    int useCache = cacheDir && !CBuild_Cache_init(&cache, cacheDir);
+
+    const char *budget = getenv("CBUILD_MEMORY_BUDGET_MB"); // optional, limits the memory of the parallel jobs
+    if (budget)
+    {
+        graph.memoryBudgetKb = atoll(budget) * 1024;
+    }
+
+    // slow translation units from the last run are started first
+    CBuild_Graph_loadDurations(&graph, "./sample/build/.cbuild_durations");
+    int failed = CBuild_Graph_run(&graph, &pool, &db, useCache ? &cache : NULL);
+    CBuild_Graph_saveDurations(&graph, "./sample/build/.cbuild_durations");
+    if (failed == 0)
+    {
+        printf("100%% Compiled successfully! %d built, %d up to date\n", graph.built, graph.upToDate);
+    }
+    if (getenv("CBUILD_REPORT"))
+    {
+        CBuild_Graph_printUsage(&graph, 5);
+    }
+    else if (failed > 0)
+    {
+        fprintf(stderr, "%d targets failed, %d skipped\n", failed, graph.skipped);
+    }
+
+    CBuild_Db_close(&db);
+    if (useCache)
+    {
+        CBuild_Cache_printStats(&cache);
+        CBuild_Cache_deinit(&cache);
+    }
+    CBuild_JobPool_deinit(&pool);
+    if (useJobserver)
+    {
+        CBuild_Jobserver_close(&jobserver);
+    }
+    CBuild_Graph_deinit(&graph);
+    CBuild_Toolchain_deinit(&toolchain);
+    CBuild_Trace_close();
 
-    CBuild_String buildDeps = CBuild_Fs_dir("./sample/code", "/*.*", CBUILD_FS_DIRMODE_FILES, " ");
-    CBuild_String finalCommand = CBuild_String_init("g++ ./sample/main.cpp ");
-    CBuild_String_concat(&finalCommand, &buildDeps);
-    CBuild_String_concatCStr(&finalCommand, "-o ./sample/build/main.exe");
-    
-    CBuild_system(finalCommand.str, "100% Compiled successfully!\n", "Failed to compile main.cpp\n");
-    
-    CBuild_String_deinit(&buildDeps);
-    CBuild_String_deinit(&finalCommand);
-    
-    return 0;
-}
\ No newline at end of file
+    return failed != 0;
+}